@@ -0,0 +1,318 @@
+#pragma once
+
+#include "graph.h"
+#include "graph.pb.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    struct SearchStatistics {
+        size_t queries = 0;
+        size_t settled_vertices = 0;
+        size_t max_settled_vertices = 0;
+    };
+
+    // A* search with landmark lower bounds (ALT). make_base picks landmarks by farthest selection and stores
+    // the distances from and to every landmark; by the triangle inequality they bound the remaining distance
+    // to the target from below, which steers the search towards it. Without landmarks this is plain Dijkstra
+    // stopping at the target, so the settled-vertex statistics of both can be compared.
+    template <typename Weight>
+    class AltRouter {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = graph::RouteInfo<Weight>;
+
+        // Row-major landmark_count x vertex_count tables. Unreachable cells hold UNREACHABLE_WEIGHT.
+        struct LandmarkDistances {
+            std::vector<VertexId> landmarks;
+            std::vector<Weight> from_landmarks;
+            std::vector<Weight> to_landmarks;
+        };
+
+        static constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::has_infinity ?
+                                                     std::numeric_limits<Weight>::infinity() :
+                                                     std::numeric_limits<Weight>::max();
+
+        AltRouter(const Graph& graph, size_t landmark_count);
+        AltRouter(const Graph& graph, LandmarkDistances&& landmark_distances);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+        std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const;
+        std::vector<std::optional<Weight>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+                                                             const std::vector<VertexId>& targets) const;
+        SearchStatistics GetSearchStatistics() const;
+        transport_catalogue_serialize::AltLandmarks GetSerializedAltLandmarks() const;
+
+    private:
+        using QueueItem = std::pair<Weight, VertexId>;
+        using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<>>;
+
+        static constexpr Weight ZERO_WEIGHT{};
+
+        const Graph& graph_;
+        LandmarkDistances landmark_distances_;
+        mutable std::mutex statistics_mutex_;
+        mutable SearchStatistics statistics_;
+
+        void SelectLandmarks(size_t landmark_count);
+        std::vector<Weight> ComputeDistances(VertexId start, bool is_backward,
+                                             const std::vector<std::vector<EdgeId>>& incoming_edges) const;
+        // Lower bound of the distance from vertex to target, or UNREACHABLE_WEIGHT if some landmark proves
+        // that the target can't be reached from the vertex at all.
+        Weight ComputeLowerBound(VertexId vertex, VertexId target) const;
+        void CheckVertex(VertexId vertex) const;
+    };
+
+    template <typename Weight>
+    AltRouter<Weight>::AltRouter(const Graph& graph, size_t landmark_count)
+            : graph_(graph)
+    {
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+        SelectLandmarks(std::min(landmark_count, graph.GetVertexCount()));
+    }
+
+    template <typename Weight>
+    AltRouter<Weight>::AltRouter(const Graph& graph, LandmarkDistances&& landmark_distances)
+            : graph_(graph), landmark_distances_(std::move(landmark_distances))
+    {
+        const size_t table_size = landmark_distances_.landmarks.size() * graph.GetVertexCount();
+        if (landmark_distances_.from_landmarks.size() != table_size || landmark_distances_.to_landmarks.size() != table_size) {
+            throw std::invalid_argument("Landmark distances don't match the graph");
+        }
+    }
+
+    template <typename Weight>
+    std::vector<Weight> AltRouter<Weight>::ComputeDistances(VertexId start, bool is_backward,
+                                                            const std::vector<std::vector<EdgeId>>& incoming_edges) const {
+        std::vector<Weight> weights(graph_.GetVertexCount(), UNREACHABLE_WEIGHT);
+        Queue queue;
+        weights[start] = ZERO_WEIGHT;
+        queue.push({ZERO_WEIGHT, start});
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > weights[vertex]) {
+                continue;
+            }
+            auto relax = [&](EdgeId edge_id, VertexId next) {
+                const Weight candidate_weight = weight + graph_.GetEdge(edge_id).weight;
+                if (candidate_weight < weights[next]) {
+                    weights[next] = candidate_weight;
+                    queue.push({candidate_weight, next});
+                }
+            };
+            if (is_backward) {
+                for (const EdgeId edge_id : incoming_edges[vertex]) {
+                    relax(edge_id, graph_.GetEdge(edge_id).from);
+                }
+            } else {
+                for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                    relax(edge_id, graph_.GetEdge(edge_id).to);
+                }
+            }
+        }
+        return weights;
+    }
+
+    // Farthest selection: every next landmark is the vertex farthest from the landmarks chosen so far,
+    // counting a vertex unrelated to all of them (another component) as the farthest of all.
+    // The first landmark is the vertex farthest from vertex 0.
+    template <typename Weight>
+    void AltRouter<Weight>::SelectLandmarks(size_t landmark_count) {
+        const size_t vertex_count = graph_.GetVertexCount();
+        std::vector<std::vector<EdgeId>> incoming_edges(vertex_count);
+        for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+            incoming_edges[graph_.GetEdge(edge_id).to].push_back(edge_id);
+        }
+
+        std::vector<Weight> closeness(vertex_count, UNREACHABLE_WEIGHT);
+        auto update_closeness = [&closeness](const std::vector<Weight>& from_weights, const std::vector<Weight>& to_weights) {
+            for (VertexId vertex = 0; vertex < closeness.size(); ++vertex) {
+                closeness[vertex] = std::min({closeness[vertex], from_weights[vertex], to_weights[vertex]});
+            }
+        };
+        auto find_farthest = [&closeness]() {
+            return static_cast<VertexId>(std::max_element(closeness.begin(), closeness.end()) - closeness.begin());
+        };
+        if (landmark_count > 0) {
+            update_closeness(ComputeDistances(0, false, incoming_edges), ComputeDistances(0, true, incoming_edges));
+        }
+
+        landmark_distances_.landmarks.reserve(landmark_count);
+        landmark_distances_.from_landmarks.reserve(landmark_count * vertex_count);
+        landmark_distances_.to_landmarks.reserve(landmark_count * vertex_count);
+        for (size_t i = 0; i < landmark_count; ++i) {
+            const VertexId landmark = find_farthest();
+            if (i == 0) {
+                closeness.assign(vertex_count, UNREACHABLE_WEIGHT);
+            }
+            const std::vector<Weight> from_weights = ComputeDistances(landmark, false, incoming_edges);
+            const std::vector<Weight> to_weights = ComputeDistances(landmark, true, incoming_edges);
+            update_closeness(from_weights, to_weights);
+
+            landmark_distances_.landmarks.push_back(landmark);
+            landmark_distances_.from_landmarks.insert(landmark_distances_.from_landmarks.end(),
+                                                      from_weights.begin(), from_weights.end());
+            landmark_distances_.to_landmarks.insert(landmark_distances_.to_landmarks.end(),
+                                                    to_weights.begin(), to_weights.end());
+        }
+    }
+
+    template <typename Weight>
+    Weight AltRouter<Weight>::ComputeLowerBound(VertexId vertex, VertexId target) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        Weight lower_bound = ZERO_WEIGHT;
+        for (size_t i = 0; i < landmark_distances_.landmarks.size(); ++i) {
+            const Weight* from_landmark = landmark_distances_.from_landmarks.data() + i * vertex_count;
+            const Weight* to_landmark = landmark_distances_.to_landmarks.data() + i * vertex_count;
+            // d(v, t) >= d(L, t) - d(L, v); if L reaches v but not t, v can't reach t either.
+            if (from_landmark[vertex] != UNREACHABLE_WEIGHT) {
+                if (from_landmark[target] == UNREACHABLE_WEIGHT) {
+                    return UNREACHABLE_WEIGHT;
+                }
+                lower_bound = std::max(lower_bound, from_landmark[target] - from_landmark[vertex]);
+            }
+            // d(v, t) >= d(v, L) - d(t, L); if t reaches L but v doesn't, v can't reach t either.
+            if (to_landmark[target] != UNREACHABLE_WEIGHT) {
+                if (to_landmark[vertex] == UNREACHABLE_WEIGHT) {
+                    return UNREACHABLE_WEIGHT;
+                }
+                lower_bound = std::max(lower_bound, to_landmark[vertex] - to_landmark[target]);
+            }
+        }
+        return lower_bound;
+    }
+
+    template <typename Weight>
+    void AltRouter<Weight>::CheckVertex(VertexId vertex) const {
+        if (vertex >= graph_.GetVertexCount()) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+    }
+
+    template <typename Weight>
+    std::optional<typename AltRouter<Weight>::RouteInfo> AltRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+        CheckVertex(from);
+        CheckVertex(to);
+        const size_t vertex_count = graph_.GetVertexCount();
+        std::vector<std::optional<Weight>> weights(vertex_count);
+        std::vector<std::optional<Weight>> lower_bounds(vertex_count);
+        std::vector<std::optional<EdgeId>> prev_edges(vertex_count);
+        auto get_lower_bound = [this, &lower_bounds, to](VertexId vertex) {
+            if (!lower_bounds[vertex]) {
+                lower_bounds[vertex] = ComputeLowerBound(vertex, to);
+            }
+            return *lower_bounds[vertex];
+        };
+
+        size_t settled_count = 0;
+        Queue queue;
+        if (get_lower_bound(from) != UNREACHABLE_WEIGHT) {
+            weights[from] = ZERO_WEIGHT;
+            queue.push({get_lower_bound(from), from});
+        }
+        while (!queue.empty()) {
+            const auto [key, vertex] = queue.top();
+            queue.pop();
+            // Rounding may leave the bounds slightly inconsistent, so a vertex is settled again whenever it improves.
+            if (key > *weights[vertex] + get_lower_bound(vertex)) {
+                continue;
+            }
+            ++settled_count;
+            if (vertex == to) {
+                break;
+            }
+            const Weight weight = *weights[vertex];
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                const Weight candidate_weight = weight + edge.weight;
+                auto& weight_to = weights[edge.to];
+                if (weight_to && !(candidate_weight < *weight_to)) {
+                    continue;
+                }
+                const Weight lower_bound = get_lower_bound(edge.to);
+                if (lower_bound == UNREACHABLE_WEIGHT) {
+                    continue;
+                }
+                weight_to = candidate_weight;
+                prev_edges[edge.to] = edge_id;
+                queue.push({candidate_weight + lower_bound, edge.to});
+            }
+        }
+
+        {
+            std::lock_guard lock(statistics_mutex_);
+            ++statistics_.queries;
+            statistics_.settled_vertices += settled_count;
+            statistics_.max_settled_vertices = std::max(statistics_.max_settled_vertices, settled_count);
+        }
+
+        if (!weights[to]) {
+            return std::nullopt;
+        }
+        std::vector<EdgeId> edges;
+        for (std::optional<EdgeId> edge_id = prev_edges[to]; edge_id; edge_id = prev_edges[graph_.GetEdge(*edge_id).from]) {
+            edges.push_back(*edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+        return RouteInfo{*weights[to], std::move(edges)};
+    }
+
+    template <typename Weight>
+    std::vector<std::optional<typename AltRouter<Weight>::RouteInfo>>
+    AltRouter<Weight>::BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const {
+        std::vector<std::optional<RouteInfo>> routes;
+        routes.reserve(targets.size());
+        for (const VertexId to : targets) {
+            routes.push_back(BuildRoute(from, to));
+        }
+        return routes;
+    }
+
+    template <typename Weight>
+    std::vector<std::optional<Weight>> AltRouter<Weight>::BuildWeightMatrix(const std::vector<VertexId>& sources,
+                                                                            const std::vector<VertexId>& targets) const {
+        std::vector<std::optional<Weight>> weights;
+        weights.reserve(sources.size() * targets.size());
+        for (const VertexId from : sources) {
+            for (const VertexId to : targets) {
+                const std::optional<RouteInfo> route = BuildRoute(from, to);
+                weights.push_back(route ? std::optional<Weight>(route->weight) : std::nullopt);
+            }
+        }
+        return weights;
+    }
+
+    template <typename Weight>
+    SearchStatistics AltRouter<Weight>::GetSearchStatistics() const {
+        std::lock_guard lock(statistics_mutex_);
+        return statistics_;
+    }
+
+    template <typename Weight>
+    transport_catalogue_serialize::AltLandmarks AltRouter<Weight>::GetSerializedAltLandmarks() const {
+        transport_catalogue_serialize::AltLandmarks alt_landmarks_serialized;
+        alt_landmarks_serialized.mutable_landmarks()->Add(landmark_distances_.landmarks.begin(),
+                                                          landmark_distances_.landmarks.end());
+        alt_landmarks_serialized.mutable_from_landmarks()->Add(landmark_distances_.from_landmarks.begin(),
+                                                               landmark_distances_.from_landmarks.end());
+        alt_landmarks_serialized.mutable_to_landmarks()->Add(landmark_distances_.to_landmarks.begin(),
+                                                             landmark_distances_.to_landmarks.end());
+        return alt_landmarks_serialized;
+    }
+}  // namespace graph
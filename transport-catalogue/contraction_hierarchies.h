@@ -0,0 +1,529 @@
+#pragma once
+
+#include "graph.h"
+#include "graph.pb.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Contracts vertices one by one in make_base, adding shortcut edges that preserve shortest paths
+    // between the vertices left. A query runs two upward Dijkstra searches over the resulting hierarchy
+    // and unpacks the shortcuts of the best meeting point back into edges of the original graph.
+    template <typename Weight>
+    class ContractionHierarchiesRouter {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+        using QueueItem = std::pair<Weight, VertexId>;
+        using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<>>;
+
+    public:
+        using RouteInfo = graph::RouteInfo<Weight>;
+
+        struct Shortcut {
+            VertexId from;
+            VertexId to;
+            Weight weight;
+            EdgeId first_edge;
+            EdgeId second_edge;
+        };
+
+        explicit ContractionHierarchiesRouter(const Graph& graph);
+        ContractionHierarchiesRouter(const Graph& graph, std::vector<size_t>&& ranks, std::vector<Shortcut>&& shortcuts);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+        std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const;
+        std::vector<std::optional<Weight>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+                                                             const std::vector<VertexId>& targets) const;
+        // Contraction order of every vertex: the most important vertices are contracted last.
+        const std::vector<size_t>& GetRanks() const;
+        transport_catalogue_serialize::ContractionHierarchies GetSerializedContractionHierarchies() const;
+
+    private:
+        struct ContractionEdge {
+            VertexId vertex;
+            Weight weight;
+            EdgeId edge_id;
+        };
+        using ContractionEdges = std::vector<std::vector<ContractionEdge>>;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        static constexpr size_t WITNESS_SEARCH_SETTLED_LIMIT = 500;
+
+        const Graph& graph_;
+        std::vector<size_t> ranks_;
+        std::vector<Shortcut> shortcuts_;
+        std::vector<size_t> upward_offsets_;
+        std::vector<EdgeId> upward_edges_;
+        std::vector<size_t> downward_offsets_;
+        std::vector<EdgeId> downward_edges_;
+
+        size_t GetEdgeCount() const {
+            return graph_.GetEdgeCount() + shortcuts_.size();
+        }
+
+        Edge<Weight> GetEdge(EdgeId edge_id) const {
+            if (edge_id < graph_.GetEdgeCount()) {
+                return graph_.GetEdge(edge_id);
+            }
+            const Shortcut& shortcut = shortcuts_[edge_id - graph_.GetEdgeCount()];
+            return {shortcut.from, shortcut.to, shortcut.weight};
+        }
+
+        void Contract();
+        void BuildSearchGraphs();
+        void AddContractionEdge(ContractionEdges& out_edges, ContractionEdges& in_edges,
+                                VertexId from, VertexId to, Weight weight, EdgeId edge_id) const;
+        std::vector<Shortcut> FindShortcuts(const ContractionEdges& out_edges, const ContractionEdges& in_edges,
+                                            VertexId vertex, std::vector<std::optional<Weight>>& witness_weights) const;
+        void UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const;
+
+        // Settles every vertex reachable from start over upward edges, or over downward edges
+        // walked in reverse for a backward search. Weights must be empty and are left empty.
+        template <typename Visitor>
+        void SearchUpward(VertexId start, bool is_backward, std::vector<std::optional<Weight>>& weights,
+                          Visitor visit) const;
+    };
+
+    template <typename Weight>
+    ContractionHierarchiesRouter<Weight>::ContractionHierarchiesRouter(const Graph& graph)
+            : graph_(graph)
+    {
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+        Contract();
+        BuildSearchGraphs();
+    }
+
+    template <typename Weight>
+    ContractionHierarchiesRouter<Weight>::ContractionHierarchiesRouter(const Graph& graph,
+                                                                       std::vector<size_t>&& ranks,
+                                                                       std::vector<Shortcut>&& shortcuts)
+            : graph_(graph), ranks_(std::move(ranks)), shortcuts_(std::move(shortcuts))
+    {
+        BuildSearchGraphs();
+    }
+
+    template <typename Weight>
+    void ContractionHierarchiesRouter<Weight>::AddContractionEdge(ContractionEdges& out_edges, ContractionEdges& in_edges,
+                                                                  VertexId from, VertexId to, Weight weight,
+                                                                  EdgeId edge_id) const {
+        auto out_it = std::find_if(out_edges[from].begin(), out_edges[from].end(), [to](const ContractionEdge& edge) {
+            return edge.vertex == to;
+        });
+        if (out_it == out_edges[from].end()) {
+            out_edges[from].push_back({to, weight, edge_id});
+            in_edges[to].push_back({from, weight, edge_id});
+            return;
+        }
+        if (weight < out_it->weight) {
+            *out_it = {to, weight, edge_id};
+            auto in_it = std::find_if(in_edges[to].begin(), in_edges[to].end(), [from](const ContractionEdge& edge) {
+                return edge.vertex == from;
+            });
+            *in_it = {from, weight, edge_id};
+        }
+    }
+
+    template <typename Weight>
+    std::vector<typename ContractionHierarchiesRouter<Weight>::Shortcut>
+    ContractionHierarchiesRouter<Weight>::FindShortcuts(const ContractionEdges& out_edges,
+                                                        const ContractionEdges& in_edges,
+                                                        VertexId vertex,
+                                                        std::vector<std::optional<Weight>>& witness_weights) const {
+        std::vector<Shortcut> shortcuts;
+        if (out_edges[vertex].empty()) {
+            return shortcuts;
+        }
+        Weight max_out_weight = ZERO_WEIGHT;
+        for (const ContractionEdge& out_edge : out_edges[vertex]) {
+            max_out_weight = std::max(max_out_weight, out_edge.weight);
+        }
+
+        std::vector<VertexId> touched;
+        for (const ContractionEdge& in_edge : in_edges[vertex]) {
+            const VertexId source = in_edge.vertex;
+            const Weight max_weight = in_edge.weight + max_out_weight;
+
+            Queue queue;
+            witness_weights[source] = ZERO_WEIGHT;
+            touched.push_back(source);
+            queue.push({ZERO_WEIGHT, source});
+            size_t settled_count = 0;
+            while (!queue.empty() && settled_count < WITNESS_SEARCH_SETTLED_LIMIT) {
+                const auto [weight, current] = queue.top();
+                queue.pop();
+                if (weight > *witness_weights[current]) {
+                    continue;
+                }
+                if (weight > max_weight) {
+                    break;
+                }
+                ++settled_count;
+                for (const ContractionEdge& edge : out_edges[current]) {
+                    if (edge.vertex == vertex) {
+                        continue;
+                    }
+                    const Weight candidate_weight = weight + edge.weight;
+                    auto& weight_to = witness_weights[edge.vertex];
+                    if (!weight_to || candidate_weight < *weight_to) {
+                        if (!weight_to) {
+                            touched.push_back(edge.vertex);
+                        }
+                        weight_to = candidate_weight;
+                        queue.push({candidate_weight, edge.vertex});
+                    }
+                }
+            }
+
+            for (const ContractionEdge& out_edge : out_edges[vertex]) {
+                if (out_edge.vertex == source) {
+                    continue;
+                }
+                const Weight shortcut_weight = in_edge.weight + out_edge.weight;
+                const auto& witness_weight = witness_weights[out_edge.vertex];
+                if (!witness_weight || shortcut_weight < *witness_weight) {
+                    shortcuts.push_back({source, out_edge.vertex, shortcut_weight, in_edge.edge_id, out_edge.edge_id});
+                }
+            }
+
+            for (const VertexId touched_vertex : touched) {
+                witness_weights[touched_vertex].reset();
+            }
+            touched.clear();
+        }
+        return shortcuts;
+    }
+
+    template <typename Weight>
+    void ContractionHierarchiesRouter<Weight>::Contract() {
+        const size_t vertex_count = graph_.GetVertexCount();
+        ContractionEdges out_edges(vertex_count);
+        ContractionEdges in_edges(vertex_count);
+        for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            if (edge.from != edge.to) {
+                AddContractionEdge(out_edges, in_edges, edge.from, edge.to, edge.weight, edge_id);
+            }
+        }
+
+        std::vector<std::optional<Weight>> witness_weights(vertex_count);
+        std::vector<int> contracted_neighbours(vertex_count, 0);
+        auto compute_priority = [&](VertexId vertex, size_t shortcut_count) {
+            return static_cast<int>(shortcut_count)
+                   - static_cast<int>(out_edges[vertex].size() + in_edges[vertex].size())
+                   + contracted_neighbours[vertex];
+        };
+
+        using PriorityItem = std::pair<int, VertexId>;
+        std::priority_queue<PriorityItem, std::vector<PriorityItem>, std::greater<>> order;
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            const size_t shortcut_count = FindShortcuts(out_edges, in_edges, vertex, witness_weights).size();
+            order.push({compute_priority(vertex, shortcut_count), vertex});
+        }
+
+        ranks_.assign(vertex_count, 0);
+        size_t next_rank = 0;
+        while (!order.empty()) {
+            const VertexId vertex = order.top().second;
+            order.pop();
+
+            std::vector<Shortcut> shortcuts = FindShortcuts(out_edges, in_edges, vertex, witness_weights);
+            const int priority = compute_priority(vertex, shortcuts.size());
+            if (!order.empty() && priority > order.top().first) {
+                order.push({priority, vertex});
+                continue;
+            }
+
+            ranks_[vertex] = next_rank++;
+            for (const ContractionEdge& in_edge : in_edges[vertex]) {
+                auto& neighbour_edges = out_edges[in_edge.vertex];
+                neighbour_edges.erase(std::remove_if(neighbour_edges.begin(), neighbour_edges.end(),
+                                                     [vertex](const ContractionEdge& edge) { return edge.vertex == vertex; }),
+                                      neighbour_edges.end());
+                ++contracted_neighbours[in_edge.vertex];
+            }
+            for (const ContractionEdge& out_edge : out_edges[vertex]) {
+                auto& neighbour_edges = in_edges[out_edge.vertex];
+                neighbour_edges.erase(std::remove_if(neighbour_edges.begin(), neighbour_edges.end(),
+                                                     [vertex](const ContractionEdge& edge) { return edge.vertex == vertex; }),
+                                      neighbour_edges.end());
+                ++contracted_neighbours[out_edge.vertex];
+            }
+            out_edges[vertex].clear();
+            in_edges[vertex].clear();
+
+            for (const Shortcut& shortcut : shortcuts) {
+                const EdgeId edge_id = GetEdgeCount();
+                shortcuts_.push_back(shortcut);
+                AddContractionEdge(out_edges, in_edges, shortcut.from, shortcut.to, shortcut.weight, edge_id);
+            }
+        }
+    }
+
+    template <typename Weight>
+    void ContractionHierarchiesRouter<Weight>::BuildSearchGraphs() {
+        const size_t vertex_count = graph_.GetVertexCount();
+        upward_offsets_.assign(vertex_count + 1, 0);
+        downward_offsets_.assign(vertex_count + 1, 0);
+        for (EdgeId edge_id = 0; edge_id < GetEdgeCount(); ++edge_id) {
+            const Edge<Weight> edge = GetEdge(edge_id);
+            if (ranks_[edge.from] < ranks_[edge.to]) {
+                ++upward_offsets_[edge.from + 1];
+            } else if (ranks_[edge.from] > ranks_[edge.to]) {
+                ++downward_offsets_[edge.to + 1];
+            }
+        }
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            upward_offsets_[vertex + 1] += upward_offsets_[vertex];
+            downward_offsets_[vertex + 1] += downward_offsets_[vertex];
+        }
+
+        upward_edges_.resize(upward_offsets_.back());
+        downward_edges_.resize(downward_offsets_.back());
+        std::vector<size_t> upward_positions(upward_offsets_.begin(), upward_offsets_.end() - 1);
+        std::vector<size_t> downward_positions(downward_offsets_.begin(), downward_offsets_.end() - 1);
+        for (EdgeId edge_id = 0; edge_id < GetEdgeCount(); ++edge_id) {
+            const Edge<Weight> edge = GetEdge(edge_id);
+            if (ranks_[edge.from] < ranks_[edge.to]) {
+                upward_edges_[upward_positions[edge.from]++] = edge_id;
+            } else if (ranks_[edge.from] > ranks_[edge.to]) {
+                downward_edges_[downward_positions[edge.to]++] = edge_id;
+            }
+        }
+    }
+
+    template <typename Weight>
+    void ContractionHierarchiesRouter<Weight>::UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const {
+        std::vector<EdgeId> stack{edge_id};
+        while (!stack.empty()) {
+            const EdgeId current = stack.back();
+            stack.pop_back();
+            if (current < graph_.GetEdgeCount()) {
+                edges.push_back(current);
+            } else {
+                const Shortcut& shortcut = shortcuts_[current - graph_.GetEdgeCount()];
+                stack.push_back(shortcut.second_edge);
+                stack.push_back(shortcut.first_edge);
+            }
+        }
+    }
+
+    template <typename Weight>
+    template <typename Visitor>
+    void ContractionHierarchiesRouter<Weight>::SearchUpward(VertexId start, bool is_backward,
+                                                            std::vector<std::optional<Weight>>& weights,
+                                                            Visitor visit) const {
+        const std::vector<size_t>& offsets = is_backward ? downward_offsets_ : upward_offsets_;
+        const std::vector<EdgeId>& search_edges = is_backward ? downward_edges_ : upward_edges_;
+
+        std::vector<VertexId> touched{start};
+        Queue queue;
+        weights[start] = ZERO_WEIGHT;
+        queue.push({ZERO_WEIGHT, start});
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > *weights[vertex]) {
+                continue;
+            }
+            visit(vertex, weight);
+            for (size_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+                const Edge<Weight> edge = GetEdge(search_edges[i]);
+                const VertexId next = is_backward ? edge.from : edge.to;
+                const Weight candidate_weight = weight + edge.weight;
+                auto& weight_next = weights[next];
+                if (!weight_next || candidate_weight < *weight_next) {
+                    if (!weight_next) {
+                        touched.push_back(next);
+                    }
+                    weight_next = candidate_weight;
+                    queue.push({candidate_weight, next});
+                }
+            }
+        }
+        for (const VertexId vertex : touched) {
+            weights[vertex].reset();
+        }
+    }
+
+    // Bucket-based many-to-many search: every target leaves its backward search space in per-vertex
+    // buckets, then each source's forward search meets them without any pairwise queries.
+    template <typename Weight>
+    std::vector<std::optional<Weight>>
+    ContractionHierarchiesRouter<Weight>::BuildWeightMatrix(const std::vector<VertexId>& sources,
+                                                            const std::vector<VertexId>& targets) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        for (const VertexId vertex : sources) {
+            if (vertex >= vertex_count) throw std::out_of_range("Vertex id is out of range");
+        }
+        for (const VertexId vertex : targets) {
+            if (vertex >= vertex_count) throw std::out_of_range("Vertex id is out of range");
+        }
+
+        struct BucketEntry {
+            size_t target_index;
+            Weight weight;
+        };
+        std::vector<std::vector<BucketEntry>> buckets(vertex_count);
+        std::vector<std::optional<Weight>> search_weights(vertex_count);
+        for (size_t target_index = 0; target_index < targets.size(); ++target_index) {
+            SearchUpward(targets[target_index], true, search_weights, [&buckets, target_index](VertexId vertex, Weight weight) {
+                buckets[vertex].push_back({target_index, weight});
+            });
+        }
+
+        std::vector<std::optional<Weight>> weights(sources.size() * targets.size());
+        for (size_t source_index = 0; source_index < sources.size(); ++source_index) {
+            std::optional<Weight>* row = weights.data() + source_index * targets.size();
+            SearchUpward(sources[source_index], false, search_weights, [&buckets, row](VertexId vertex, Weight weight) {
+                for (const BucketEntry& entry : buckets[vertex]) {
+                    const Weight candidate_weight = weight + entry.weight;
+                    if (!row[entry.target_index] || candidate_weight < *row[entry.target_index]) {
+                        row[entry.target_index] = candidate_weight;
+                    }
+                }
+            });
+        }
+        return weights;
+    }
+
+    template <typename Weight>
+    std::vector<std::optional<typename ContractionHierarchiesRouter<Weight>::RouteInfo>>
+    ContractionHierarchiesRouter<Weight>::BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const {
+        std::vector<std::optional<RouteInfo>> routes;
+        routes.reserve(targets.size());
+        for (const VertexId to : targets) {
+            routes.push_back(BuildRoute(from, to));
+        }
+        return routes;
+    }
+
+    template <typename Weight>
+    std::optional<typename ContractionHierarchiesRouter<Weight>::RouteInfo>
+    ContractionHierarchiesRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+
+        std::vector<std::optional<Weight>> forward_weights(vertex_count);
+        std::vector<std::optional<Weight>> backward_weights(vertex_count);
+        std::vector<std::optional<EdgeId>> forward_prev_edges(vertex_count);
+        std::vector<std::optional<EdgeId>> backward_next_edges(vertex_count);
+        Queue forward_queue;
+        Queue backward_queue;
+
+        forward_weights[from] = ZERO_WEIGHT;
+        forward_queue.push({ZERO_WEIGHT, from});
+        backward_weights[to] = ZERO_WEIGHT;
+        backward_queue.push({ZERO_WEIGHT, to});
+
+        std::optional<Weight> best_weight;
+        VertexId meeting_vertex = from;
+
+        auto update_best = [&](VertexId vertex) {
+            if (forward_weights[vertex] && backward_weights[vertex]) {
+                const Weight weight = *forward_weights[vertex] + *backward_weights[vertex];
+                if (!best_weight || weight < *best_weight) {
+                    best_weight = weight;
+                    meeting_vertex = vertex;
+                }
+            }
+        };
+
+        auto is_search_finished = [&best_weight](const Queue& queue) {
+            return queue.empty() || (best_weight && queue.top().first >= *best_weight);
+        };
+
+        while (!is_search_finished(forward_queue) || !is_search_finished(backward_queue)) {
+            if (!is_search_finished(forward_queue)) {
+                const auto [weight, vertex] = forward_queue.top();
+                forward_queue.pop();
+                if (weight <= *forward_weights[vertex]) {
+                    update_best(vertex);
+                    for (size_t i = upward_offsets_[vertex]; i < upward_offsets_[vertex + 1]; ++i) {
+                        const Edge<Weight> edge = GetEdge(upward_edges_[i]);
+                        const Weight candidate_weight = weight + edge.weight;
+                        auto& weight_to = forward_weights[edge.to];
+                        if (!weight_to || candidate_weight < *weight_to) {
+                            weight_to = candidate_weight;
+                            forward_prev_edges[edge.to] = upward_edges_[i];
+                            forward_queue.push({candidate_weight, edge.to});
+                        }
+                    }
+                }
+            }
+            if (!is_search_finished(backward_queue)) {
+                const auto [weight, vertex] = backward_queue.top();
+                backward_queue.pop();
+                if (weight <= *backward_weights[vertex]) {
+                    update_best(vertex);
+                    for (size_t i = downward_offsets_[vertex]; i < downward_offsets_[vertex + 1]; ++i) {
+                        const Edge<Weight> edge = GetEdge(downward_edges_[i]);
+                        const Weight candidate_weight = weight + edge.weight;
+                        auto& weight_from = backward_weights[edge.from];
+                        if (!weight_from || candidate_weight < *weight_from) {
+                            weight_from = candidate_weight;
+                            backward_next_edges[edge.from] = downward_edges_[i];
+                            backward_queue.push({candidate_weight, edge.from});
+                        }
+                    }
+                }
+            }
+        }
+
+        if (!best_weight) {
+            return std::nullopt;
+        }
+
+        std::vector<EdgeId> forward_edges;
+        for (VertexId vertex = meeting_vertex; vertex != from; vertex = GetEdge(*forward_prev_edges[vertex]).from) {
+            forward_edges.push_back(*forward_prev_edges[vertex]);
+        }
+        std::reverse(forward_edges.begin(), forward_edges.end());
+
+        std::vector<EdgeId> edges;
+        for (const EdgeId edge_id : forward_edges) {
+            UnpackEdge(edge_id, edges);
+        }
+        for (VertexId vertex = meeting_vertex; vertex != to; vertex = GetEdge(*backward_next_edges[vertex]).to) {
+            UnpackEdge(*backward_next_edges[vertex], edges);
+        }
+
+        return RouteInfo{*best_weight, std::move(edges)};
+    }
+
+    template <typename Weight>
+    const std::vector<size_t>& ContractionHierarchiesRouter<Weight>::GetRanks() const {
+        return ranks_;
+    }
+
+    template <typename Weight>
+    transport_catalogue_serialize::ContractionHierarchies
+    ContractionHierarchiesRouter<Weight>::GetSerializedContractionHierarchies() const {
+        transport_catalogue_serialize::ContractionHierarchies contraction_hierarchies_serialized;
+        for (size_t rank : ranks_) {
+            contraction_hierarchies_serialized.add_ranks(rank);
+        }
+        for (const Shortcut& shortcut : shortcuts_) {
+            transport_catalogue_serialize::Shortcut shortcut_serialized;
+            shortcut_serialized.set_from_id(shortcut.from);
+            shortcut_serialized.set_to_id(shortcut.to);
+            shortcut_serialized.set_weight(shortcut.weight);
+            shortcut_serialized.set_first_edge_id(shortcut.first_edge);
+            shortcut_serialized.set_second_edge_id(shortcut.second_edge);
+            *contraction_hierarchies_serialized.add_shortcuts() = std::move(shortcut_serialized);
+        }
+        return contraction_hierarchies_serialized;
+    }
+}  // namespace graph
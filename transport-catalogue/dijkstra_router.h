@@ -0,0 +1,176 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    template <typename Weight>
+    struct ShortestPathTree {
+        std::vector<std::optional<Weight>> weights;
+        std::vector<std::optional<EdgeId>> prev_edges;
+    };
+
+    // Grows the tree until every target is settled, or over the whole reachable graph if there are no targets.
+    // With max_weight the tree only holds vertices within that weight of the start, all with exact weights.
+    template <typename Weight>
+    ShortestPathTree<Weight> BuildShortestPathTree(const DirectedWeightedGraph<Weight>& graph, VertexId from,
+                                                   const std::vector<VertexId>& targets,
+                                                   std::optional<Weight> max_weight = std::nullopt);
+
+    // Answers every query with a binary-heap Dijkstra search over the graph.
+    // Nothing is precomputed, so memory stays linear in the size of the graph.
+    template <typename Weight>
+    class DijkstraRouter {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = graph::RouteInfo<Weight>;
+
+        explicit DijkstraRouter(const Graph& graph);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+        std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const;
+        std::vector<std::optional<Weight>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+                                                             const std::vector<VertexId>& targets) const;
+
+        ShortestPathTree<Weight> BuildShortestPathTree(VertexId from, const std::vector<VertexId>& targets) const;
+        std::optional<RouteInfo> ExtractRoute(const ShortestPathTree<Weight>& tree, VertexId to) const;
+
+    private:
+        static constexpr Weight ZERO_WEIGHT{};
+        const Graph& graph_;
+    };
+
+    template <typename Weight>
+    DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph)
+            : graph_(graph)
+    {
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+
+    template <typename Weight>
+    std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(VertexId from,
+                                                                                                 VertexId to) const {
+        return ExtractRoute(BuildShortestPathTree(from, {to}), to);
+    }
+
+    template <typename Weight>
+    std::vector<std::optional<typename DijkstraRouter<Weight>::RouteInfo>>
+    DijkstraRouter<Weight>::BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const {
+        const ShortestPathTree<Weight> tree = BuildShortestPathTree(from, targets);
+        std::vector<std::optional<RouteInfo>> routes;
+        routes.reserve(targets.size());
+        for (const VertexId to : targets) {
+            routes.push_back(ExtractRoute(tree, to));
+        }
+        return routes;
+    }
+
+    template <typename Weight>
+    ShortestPathTree<Weight> DijkstraRouter<Weight>::BuildShortestPathTree(VertexId from,
+                                                                           const std::vector<VertexId>& targets) const {
+        return graph::BuildShortestPathTree(graph_, from, targets);
+    }
+
+    template <typename Weight>
+    std::vector<std::optional<Weight>> DijkstraRouter<Weight>::BuildWeightMatrix(const std::vector<VertexId>& sources,
+                                                                                 const std::vector<VertexId>& targets) const {
+        std::vector<std::optional<Weight>> weights;
+        weights.reserve(sources.size() * targets.size());
+        for (const VertexId from : sources) {
+            const ShortestPathTree<Weight> tree = BuildShortestPathTree(from, targets);
+            for (const VertexId to : targets) {
+                weights.push_back(tree.weights[to]);
+            }
+        }
+        return weights;
+    }
+
+    template <typename Weight>
+    std::optional<typename DijkstraRouter<Weight>::RouteInfo>
+    DijkstraRouter<Weight>::ExtractRoute(const ShortestPathTree<Weight>& tree, VertexId to) const {
+        if (!tree.weights.at(to)) {
+            return std::nullopt;
+        }
+        std::vector<EdgeId> edges;
+        for (std::optional<EdgeId> edge_id = tree.prev_edges[to];
+             edge_id;
+             edge_id = tree.prev_edges[graph_.GetEdge(*edge_id).from])
+        {
+            edges.push_back(*edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+
+        return RouteInfo{*tree.weights[to], std::move(edges)};
+    }
+
+    template <typename Weight>
+    ShortestPathTree<Weight> BuildShortestPathTree(const DirectedWeightedGraph<Weight>& graph, VertexId from,
+                                                   const std::vector<VertexId>& targets,
+                                                   std::optional<Weight> max_weight) {
+        using QueueItem = std::pair<Weight, VertexId>;
+        constexpr Weight ZERO_WEIGHT{};
+        const size_t vertex_count = graph.GetVertexCount();
+        if (from >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        std::vector<bool> is_target(vertex_count, false);
+        size_t targets_left = 0;
+        for (const VertexId to : targets) {
+            if (to >= vertex_count) {
+                throw std::out_of_range("Vertex id is out of range");
+            }
+            if (!is_target[to]) {
+                is_target[to] = true;
+                ++targets_left;
+            }
+        }
+
+        ShortestPathTree<Weight> tree{std::vector<std::optional<Weight>>(vertex_count),
+                                      std::vector<std::optional<EdgeId>>(vertex_count)};
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<>> queue;
+
+        tree.weights[from] = ZERO_WEIGHT;
+        queue.push({ZERO_WEIGHT, from});
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > *tree.weights[vertex]) {
+                continue;
+            }
+            if (is_target[vertex]) {
+                is_target[vertex] = false;
+                if (--targets_left == 0) {
+                    break;
+                }
+            }
+            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+                const auto& edge = graph.GetEdge(edge_id);
+                const Weight candidate_weight = weight + edge.weight;
+                if (max_weight && candidate_weight > *max_weight) {
+                    continue;
+                }
+                auto& weight_to = tree.weights[edge.to];
+                if (!weight_to || candidate_weight < *weight_to) {
+                    weight_to = candidate_weight;
+                    tree.prev_edges[edge.to] = edge_id;
+                    queue.push({candidate_weight, edge.to});
+                }
+            }
+        }
+        return tree;
+    }
+}  // namespace graph
@@ -2,9 +2,11 @@
 
 #include <utility>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <set>
+#include <memory_resource>
 #include <optional>
+#include <cstdint>
 
 namespace domain {
 
@@ -14,22 +16,29 @@ namespace domain {
     };
 
     struct Stop {
-        Stop(std::string name, double lat, double lon)
-                : name_(std::move(name)), latitude_(lat), longitude_(lon) {}
+        Stop(std::string_view name, double lat, double lon)
+                : name_(name), latitude_(lat), longitude_(lon) {}
 
-        std::string name_;
+        // Points into the catalogue arena.
+        std::string_view name_;
         double latitude_;
         double longitude_;
+        uint32_t id_ = 0;
     };
 
     struct Bus {
-        Bus(std::string name, std::vector<const Stop*> stops, size_t unique_stops, BusType type)
-                : name_(std::move(name)), stops_(std::move(stops)), unique_stops_(unique_stops), type_(type) {}
+        Bus(std::string_view name, std::pmr::vector<const Stop*> stops, size_t unique_stops, BusType type)
+                : name_(name), stops_(std::move(stops)), unique_stops_(unique_stops), type_(type) {}
 
-        std::string name_;
-        std::vector<const Stop*> stops_;
+        // Both live in the catalogue arena.
+        std::string_view name_;
+        std::pmr::vector<const Stop*> stops_;
         size_t unique_stops_;
         BusType type_;
+        uint32_t id_ = 0;
+        // Set by the catalogue.
+        int route_length_ = 0;
+        double curvature_ = 0.0;
     };
 
     struct RawBus {
@@ -46,8 +55,15 @@ namespace domain {
         double curvature_;
     };
 
+    struct NearbyStop {
+        std::string_view name_;
+        // In metres.
+        double distance_;
+    };
+
     struct StopInfo {
         std::string_view name_;
-        const std::set<std::string_view>* buses_;
+        // Sorted by name.
+        std::vector<std::string_view> buses_;
     };
 }
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <utility>
 
 namespace geo {
 
@@ -27,4 +30,32 @@ namespace geo {
                     + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr))
                * 6371000;
     }
+
+    // Position of the point along a Hilbert curve of the given order laid over the bounding box.
+    // Points close on the curve are close on the map, so sorting by it keeps neighbours together.
+    inline uint64_t ComputeHilbertIndex(Coordinates point, Coordinates min, Coordinates max, int order = 16) {
+        const uint32_t side = uint32_t{1} << order;
+        auto to_cell = [side](double value, double min_value, double max_value) {
+            if (max_value - min_value < EPSILON) return uint32_t{0};
+            const double position = (value - min_value) / (max_value - min_value) * (side - 1);
+            return static_cast<uint32_t>(std::lround(std::clamp(position, 0.0, side - 1.0)));
+        };
+        uint32_t x = to_cell(point.lng, min.lng, max.lng);
+        uint32_t y = to_cell(point.lat, min.lat, max.lat);
+
+        uint64_t index = 0;
+        for (uint32_t s = side / 2; s > 0; s /= 2) {
+            const uint32_t rx = (x & s) > 0 ? 1 : 0;
+            const uint32_t ry = (y & s) > 0 ? 1 : 0;
+            index += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+            if (ry == 0) {
+                if (rx == 1) {
+                    x = side - 1 - x;
+                    y = side - 1 - y;
+                }
+                std::swap(x, y);
+            }
+        }
+        return index;
+    }
 }
\ No newline at end of file
@@ -3,7 +3,9 @@
 #include "ranges.h"
 #include "graph.pb.h"
 
+#include <cassert>
 #include <cstdlib>
+#include <stdexcept>
 #include <vector>
 
 namespace graph {
@@ -18,17 +20,32 @@ namespace graph {
         Weight weight;
     };
 
+    template <typename Weight>
+    struct RouteInfo {
+        Weight weight;
+        std::vector<EdgeId> edges;
+    };
+
+    // Edges are added to a mutable graph, which is then frozen into compressed sparse row form:
+    // the edges are sorted by source, so the outgoing edges of a vertex are one contiguous id interval
+    // described by an offsets array. Searches may only run on a frozen graph.
     template <typename Weight>
     class DirectedWeightedGraph {
     private:
-        using IncidenceList = std::vector<EdgeId>;
-        using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+        using IncidentEdgesRange = decltype(ranges::AsCountingRange(EdgeId{}, EdgeId{}));
 
     public:
         DirectedWeightedGraph() = default;
         explicit DirectedWeightedGraph(size_t vertex_count);
-        DirectedWeightedGraph(std::vector<Edge<Weight>>&& edges, std::vector<IncidenceList>&& incidence_lists);
+        // Builds a frozen graph from CSR arrays: offsets has vertex_count + 1 entries, targets and weights one per edge.
+        DirectedWeightedGraph(std::vector<size_t>&& offsets, const std::vector<VertexId>& targets, const std::vector<Weight>& weights);
         EdgeId AddEdge(const Edge<Weight>& edge);
+        // Stable-sorts the edges by source. Returns the old edge ids in their new order,
+        // so anything indexed by edge id can be rearranged to match.
+        std::vector<EdgeId> Freeze();
+        bool IsFrozen() const;
+        // Copy of a frozen graph with the same vertices and edges and new weights, given in edge id order.
+        DirectedWeightedGraph WithWeights(const std::vector<Weight>& weights) const;
 
         size_t GetVertexCount() const;
         size_t GetEdgeCount() const;
@@ -38,31 +55,93 @@ namespace graph {
     transport_catalogue_serialize::Graph GetSerializedGraph() const;
 
     private:
+        size_t vertex_count_ = 0;
         std::vector<Edge<Weight>> edges_;
-        std::vector<IncidenceList> incidence_lists_;
+        std::vector<size_t> offsets_;
     };
 
     template <typename Weight>
     DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-            : incidence_lists_(vertex_count) {
+            : vertex_count_(vertex_count) {
     }
 
     template <typename Weight>
-    DirectedWeightedGraph<Weight>::DirectedWeightedGraph(std::vector<Edge<Weight>>&& edges, std::vector<IncidenceList>&& incidence_lists)
-            : edges_(edges), incidence_lists_(incidence_lists) {
+    DirectedWeightedGraph<Weight>::DirectedWeightedGraph(std::vector<size_t>&& offsets,
+                                                         const std::vector<VertexId>& targets,
+                                                         const std::vector<Weight>& weights)
+            : offsets_(std::move(offsets)) {
+        if (offsets_.empty() || offsets_.back() != targets.size() || targets.size() != weights.size()) {
+            throw std::invalid_argument("Graph arrays don't match each other");
+        }
+        vertex_count_ = offsets_.size() - 1;
+        edges_.reserve(targets.size());
+        for (VertexId from = 0; from < vertex_count_; ++from) {
+            for (EdgeId edge_id = offsets_[from]; edge_id < offsets_[from + 1]; ++edge_id) {
+                edges_.push_back({from, targets[edge_id], weights[edge_id]});
+            }
+        }
     }
 
     template <typename Weight>
     EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+        if (IsFrozen()) {
+            throw std::logic_error("Can't add an edge to a frozen graph");
+        }
+        if (edge.from >= vertex_count_ || edge.to >= vertex_count_) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
         edges_.push_back(edge);
-        const EdgeId id = edges_.size() - 1;
-        incidence_lists_.at(edge.from).push_back(id);
-        return id;
+        return edges_.size() - 1;
+    }
+
+    template <typename Weight>
+    std::vector<EdgeId> DirectedWeightedGraph<Weight>::Freeze() {
+        offsets_.assign(vertex_count_ + 1, 0);
+        for (const Edge<Weight>& edge : edges_) {
+            ++offsets_[edge.from + 1];
+        }
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            offsets_[vertex + 1] += offsets_[vertex];
+        }
+
+        std::vector<EdgeId> old_ids(edges_.size());
+        std::vector<size_t> positions(offsets_.begin(), offsets_.end() - 1);
+        for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+            old_ids[positions[edges_[edge_id].from]++] = edge_id;
+        }
+
+        std::vector<Edge<Weight>> sorted_edges;
+        sorted_edges.reserve(edges_.size());
+        for (const EdgeId edge_id : old_ids) {
+            sorted_edges.push_back(edges_[edge_id]);
+        }
+        edges_ = std::move(sorted_edges);
+        return old_ids;
+    }
+
+    template <typename Weight>
+    bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+        return !offsets_.empty();
+    }
+
+    template <typename Weight>
+    DirectedWeightedGraph<Weight> DirectedWeightedGraph<Weight>::WithWeights(const std::vector<Weight>& weights) const {
+        if (!IsFrozen()) {
+            throw std::logic_error("Only a frozen graph can be re-weighted");
+        }
+        if (weights.size() != edges_.size()) {
+            throw std::invalid_argument("Weights don't match the graph's edges");
+        }
+        DirectedWeightedGraph graph = *this;
+        for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+            graph.edges_[edge_id].weight = weights[edge_id];
+        }
+        return graph;
     }
 
     template <typename Weight>
     size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-        return incidence_lists_.size();
+        return vertex_count_;
     }
 
     template <typename Weight>
@@ -72,34 +151,27 @@ namespace graph {
 
     template <typename Weight>
     const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
-        return edges_.at(edge_id);
+        assert(edge_id < edges_.size());
+        return edges_[edge_id];
     }
 
     template <typename Weight>
     typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
     DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-        return ranges::AsRange(incidence_lists_.at(vertex));
+        assert(IsFrozen() && vertex < vertex_count_);
+        return ranges::AsCountingRange(offsets_[vertex], offsets_[vertex + 1]);
     }
 
     template<typename Weight>
     transport_catalogue_serialize::Graph DirectedWeightedGraph<Weight>::GetSerializedGraph() const {
         transport_catalogue_serialize::Graph graph_serialized;
-        for (auto& edge : edges_) {
-            transport_catalogue_serialize::Edge edge_serialized;
-            edge_serialized.set_from_id(edge.from);
-            edge_serialized.set_to_id(edge.to);
-            edge_serialized.set_weight(edge.weight);
-            *graph_serialized.add_edges() = std::move(edge_serialized);
+        graph_serialized.mutable_offsets()->Add(offsets_.begin(), offsets_.end());
+        graph_serialized.mutable_targets()->Reserve(static_cast<int>(edges_.size()));
+        graph_serialized.mutable_weights()->Reserve(static_cast<int>(edges_.size()));
+        for (const Edge<Weight>& edge : edges_) {
+            graph_serialized.add_targets(edge.to);
+            graph_serialized.add_weights(edge.weight);
         }
-
-        for (auto& incidence_list : incidence_lists_ ) {
-            transport_catalogue_serialize::IncidenceList incidence_list_serialized;
-            for (auto elem : incidence_list) {
-                incidence_list_serialized.add_edge_ids(elem);
-            }
-            *graph_serialized.add_incidence_lists() = std::move(incidence_list_serialized);
-        }
-
         return graph_serialized;
     }
-}  // namespace graph
\ No newline at end of file
+}  // namespace graph
@@ -0,0 +1,369 @@
+#pragma once
+
+#include "contraction_hierarchies.h"
+#include "graph.h"
+#include "graph.pb.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Two-hop labels built in make_base by pruned landmark labeling. Every vertex keeps the hubs it reaches
+    // (out label) and the hubs that reach it (in label), sorted by hub rank, so that a query is a single merge
+    // of two short arrays. Each label entry also keeps the first edge towards its hub (or from it, for in labels),
+    // which is enough to walk the route back edge by edge through the neighbours' labels.
+    template <typename Weight>
+    class HubLabelsRouter {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = graph::RouteInfo<Weight>;
+
+        // The weight goes first so that an entry of double weights packs into 16 bytes.
+        struct LabelEntry {
+            Weight weight;
+            uint32_t hub;
+            uint32_t edge;
+        };
+
+        // Per-vertex labels stored back to back: the label of vertex v is entries[offsets[v], offsets[v + 1]).
+        struct Labels {
+            std::vector<size_t> offsets;
+            std::vector<LabelEntry> entries;
+        };
+
+        static constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+        explicit HubLabelsRouter(const Graph& graph);
+        HubLabelsRouter(const Graph& graph, Labels&& out_labels, Labels&& in_labels);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+        std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const;
+        std::vector<std::optional<Weight>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+                                                             const std::vector<VertexId>& targets) const;
+        size_t GetLabelEntryCount() const;
+        transport_catalogue_serialize::HubLabels GetSerializedHubLabels() const;
+
+    private:
+        using QueueItem = std::pair<Weight, VertexId>;
+        using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<>>;
+        using LabelsUnderConstruction = std::vector<std::vector<LabelEntry>>;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        static constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::has_infinity ?
+                                                     std::numeric_limits<Weight>::infinity() :
+                                                     std::numeric_limits<Weight>::max();
+
+        const Graph& graph_;
+        Labels out_labels_;
+        Labels in_labels_;
+
+        std::vector<VertexId> ComputeVertexOrder() const;
+        void BuildLabels();
+        // Dijkstra from the hub over outgoing edges (or incoming ones for a backward search) that stops
+        // at every vertex whose distance the labels built so far already cover.
+        void AddPrunedLabels(VertexId hub_vertex, uint32_t hub, bool is_backward,
+                             const std::vector<std::vector<EdgeId>>& incoming_edges,
+                             LabelsUnderConstruction& labels, const std::vector<LabelEntry>& hub_label,
+                             std::vector<Weight>& hub_weights, std::vector<Weight>& weights,
+                             std::vector<uint32_t>& parent_edges) const;
+
+        std::optional<std::pair<Weight, uint32_t>> FindBestHub(VertexId from, VertexId to) const;
+        const LabelEntry& FindLabelEntry(const Labels& labels, VertexId vertex, uint32_t hub) const;
+
+        static Labels FlattenLabels(LabelsUnderConstruction&& labels);
+        static void CheckLabels(const Labels& labels, size_t vertex_count);
+    };
+
+    template <typename Weight>
+    HubLabelsRouter<Weight>::HubLabelsRouter(const Graph& graph)
+            : graph_(graph)
+    {
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+        if (graph.GetEdgeCount() >= NO_EDGE || graph.GetVertexCount() >= NO_EDGE) {
+            throw std::length_error("Too many edges for the hub labels router");
+        }
+        BuildLabels();
+    }
+
+    template <typename Weight>
+    HubLabelsRouter<Weight>::HubLabelsRouter(const Graph& graph, Labels&& out_labels, Labels&& in_labels)
+            : graph_(graph), out_labels_(std::move(out_labels)), in_labels_(std::move(in_labels))
+    {
+        CheckLabels(out_labels_, graph.GetVertexCount());
+        CheckLabels(in_labels_, graph.GetVertexCount());
+    }
+
+    template <typename Weight>
+    void HubLabelsRouter<Weight>::CheckLabels(const Labels& labels, size_t vertex_count) {
+        if (labels.offsets.size() != vertex_count + 1 || labels.offsets.back() != labels.entries.size()) {
+            throw std::invalid_argument("Hub labels don't match the graph");
+        }
+    }
+
+    // Vertices where many routes meet make the best hubs. Contraction hierarchies leave exactly those for last,
+    // so the reversed contraction order gives labels several times smaller than ordering by vertex degree.
+    template <typename Weight>
+    std::vector<VertexId> HubLabelsRouter<Weight>::ComputeVertexOrder() const {
+        const ContractionHierarchiesRouter<Weight> contraction_hierarchies(graph_);
+        const std::vector<size_t>& ranks = contraction_hierarchies.GetRanks();
+        std::vector<VertexId> order(ranks.size());
+        for (VertexId vertex = 0; vertex < ranks.size(); ++vertex) {
+            order[ranks.size() - 1 - ranks[vertex]] = vertex;
+        }
+        return order;
+    }
+
+    template <typename Weight>
+    void HubLabelsRouter<Weight>::BuildLabels() {
+        const size_t vertex_count = graph_.GetVertexCount();
+        std::vector<std::vector<EdgeId>> incoming_edges(vertex_count);
+        for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+            incoming_edges[graph_.GetEdge(edge_id).to].push_back(edge_id);
+        }
+
+        LabelsUnderConstruction out_labels(vertex_count);
+        LabelsUnderConstruction in_labels(vertex_count);
+        std::vector<Weight> hub_weights(vertex_count, UNREACHABLE_WEIGHT);
+        std::vector<Weight> weights(vertex_count, UNREACHABLE_WEIGHT);
+        std::vector<uint32_t> parent_edges(vertex_count, NO_EDGE);
+
+        const std::vector<VertexId> order = ComputeVertexOrder();
+        for (uint32_t hub = 0; hub < vertex_count; ++hub) {
+            const VertexId hub_vertex = order[hub];
+            // Forward search fills in labels, so it is pruned against the hub's own out label, and vice versa.
+            AddPrunedLabels(hub_vertex, hub, false, incoming_edges, in_labels, out_labels[hub_vertex],
+                            hub_weights, weights, parent_edges);
+            AddPrunedLabels(hub_vertex, hub, true, incoming_edges, out_labels, in_labels[hub_vertex],
+                            hub_weights, weights, parent_edges);
+        }
+
+        out_labels_ = FlattenLabels(std::move(out_labels));
+        in_labels_ = FlattenLabels(std::move(in_labels));
+    }
+
+    template <typename Weight>
+    void HubLabelsRouter<Weight>::AddPrunedLabels(VertexId hub_vertex, uint32_t hub, bool is_backward,
+                                                  const std::vector<std::vector<EdgeId>>& incoming_edges,
+                                                  LabelsUnderConstruction& labels,
+                                                  const std::vector<LabelEntry>& hub_label,
+                                                  std::vector<Weight>& hub_weights, std::vector<Weight>& weights,
+                                                  std::vector<uint32_t>& parent_edges) const {
+        for (const LabelEntry& entry : hub_label) {
+            hub_weights[entry.hub] = entry.weight;
+        }
+
+        std::vector<VertexId> touched{hub_vertex};
+        Queue queue;
+        weights[hub_vertex] = ZERO_WEIGHT;
+        queue.push({ZERO_WEIGHT, hub_vertex});
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > weights[vertex]) {
+                continue;
+            }
+            const std::vector<LabelEntry>& vertex_label = labels[vertex];
+            const bool is_covered = std::any_of(vertex_label.begin(), vertex_label.end(),
+                                                [&hub_weights, weight = weight](const LabelEntry& entry) {
+                return hub_weights[entry.hub] + entry.weight <= weight;
+            });
+            if (is_covered) {
+                continue;
+            }
+            labels[vertex].push_back({weight, hub, parent_edges[vertex]});
+
+            auto relax = [&](EdgeId edge_id, VertexId next) {
+                const Weight candidate_weight = weight + graph_.GetEdge(edge_id).weight;
+                if (candidate_weight < weights[next]) {
+                    if (weights[next] == UNREACHABLE_WEIGHT) {
+                        touched.push_back(next);
+                    }
+                    weights[next] = candidate_weight;
+                    parent_edges[next] = static_cast<uint32_t>(edge_id);
+                    queue.push({candidate_weight, next});
+                }
+            };
+            if (is_backward) {
+                for (const EdgeId edge_id : incoming_edges[vertex]) {
+                    relax(edge_id, graph_.GetEdge(edge_id).from);
+                }
+            } else {
+                for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                    relax(edge_id, graph_.GetEdge(edge_id).to);
+                }
+            }
+        }
+
+        for (const VertexId vertex : touched) {
+            weights[vertex] = UNREACHABLE_WEIGHT;
+            parent_edges[vertex] = NO_EDGE;
+        }
+        for (const LabelEntry& entry : hub_label) {
+            hub_weights[entry.hub] = UNREACHABLE_WEIGHT;
+        }
+    }
+
+    template <typename Weight>
+    typename HubLabelsRouter<Weight>::Labels HubLabelsRouter<Weight>::FlattenLabels(LabelsUnderConstruction&& labels) {
+        Labels flat_labels;
+        flat_labels.offsets.reserve(labels.size() + 1);
+        flat_labels.offsets.push_back(0);
+        for (const std::vector<LabelEntry>& label : labels) {
+            flat_labels.offsets.push_back(flat_labels.offsets.back() + label.size());
+        }
+        flat_labels.entries.reserve(flat_labels.offsets.back());
+        for (std::vector<LabelEntry>& label : labels) {
+            flat_labels.entries.insert(flat_labels.entries.end(), label.begin(), label.end());
+            std::vector<LabelEntry>().swap(label);
+        }
+        return flat_labels;
+    }
+
+    // Both labels are sorted by hub rank, so the common hubs are found in one linear merge.
+    template <typename Weight>
+    std::optional<std::pair<Weight, uint32_t>> HubLabelsRouter<Weight>::FindBestHub(VertexId from, VertexId to) const {
+        const LabelEntry* out_it = out_labels_.entries.data() + out_labels_.offsets[from];
+        const LabelEntry* const out_end = out_labels_.entries.data() + out_labels_.offsets[from + 1];
+        const LabelEntry* in_it = in_labels_.entries.data() + in_labels_.offsets[to];
+        const LabelEntry* const in_end = in_labels_.entries.data() + in_labels_.offsets[to + 1];
+
+        std::optional<std::pair<Weight, uint32_t>> best;
+        while (out_it != out_end && in_it != in_end) {
+            if (out_it->hub < in_it->hub) {
+                ++out_it;
+            } else if (in_it->hub < out_it->hub) {
+                ++in_it;
+            } else {
+                const Weight weight = out_it->weight + in_it->weight;
+                if (!best || weight < best->first) {
+                    best = {weight, out_it->hub};
+                }
+                ++out_it;
+                ++in_it;
+            }
+        }
+        return best;
+    }
+
+    template <typename Weight>
+    const typename HubLabelsRouter<Weight>::LabelEntry&
+    HubLabelsRouter<Weight>::FindLabelEntry(const Labels& labels, VertexId vertex, uint32_t hub) const {
+        const auto begin = labels.entries.begin() + labels.offsets[vertex];
+        const auto end = labels.entries.begin() + labels.offsets[vertex + 1];
+        const auto it = std::lower_bound(begin, end, hub, [](const LabelEntry& entry, uint32_t value) {
+            return entry.hub < value;
+        });
+        // Every vertex on a labelled path to the hub was labelled by the same search.
+        if (it == end || it->hub != hub) {
+            throw std::logic_error("Hub labels are inconsistent");
+        }
+        return *it;
+    }
+
+    template <typename Weight>
+    std::optional<typename HubLabelsRouter<Weight>::RouteInfo>
+    HubLabelsRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        const auto best_hub = FindBestHub(from, to);
+        if (!best_hub) {
+            return std::nullopt;
+        }
+        const uint32_t hub = best_hub->second;
+
+        std::vector<EdgeId> edges;
+        for (VertexId vertex = from;;) {
+            const uint32_t edge_id = FindLabelEntry(out_labels_, vertex, hub).edge;
+            if (edge_id == NO_EDGE) {
+                break;
+            }
+            edges.push_back(edge_id);
+            vertex = graph_.GetEdge(edge_id).to;
+        }
+        const size_t forward_edge_count = edges.size();
+        for (VertexId vertex = to;;) {
+            const uint32_t edge_id = FindLabelEntry(in_labels_, vertex, hub).edge;
+            if (edge_id == NO_EDGE) {
+                break;
+            }
+            edges.push_back(edge_id);
+            vertex = graph_.GetEdge(edge_id).from;
+        }
+        std::reverse(edges.begin() + forward_edge_count, edges.end());
+
+        return RouteInfo{best_hub->first, std::move(edges)};
+    }
+
+    template <typename Weight>
+    std::vector<std::optional<typename HubLabelsRouter<Weight>::RouteInfo>>
+    HubLabelsRouter<Weight>::BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const {
+        std::vector<std::optional<RouteInfo>> routes;
+        routes.reserve(targets.size());
+        for (const VertexId to : targets) {
+            routes.push_back(BuildRoute(from, to));
+        }
+        return routes;
+    }
+
+    template <typename Weight>
+    std::vector<std::optional<Weight>> HubLabelsRouter<Weight>::BuildWeightMatrix(const std::vector<VertexId>& sources,
+                                                                                  const std::vector<VertexId>& targets) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        std::vector<std::optional<Weight>> weights;
+        weights.reserve(sources.size() * targets.size());
+        for (const VertexId from : sources) {
+            for (const VertexId to : targets) {
+                if (from >= vertex_count || to >= vertex_count) {
+                    throw std::out_of_range("Vertex id is out of range");
+                }
+                const auto best_hub = FindBestHub(from, to);
+                weights.push_back(best_hub ? std::optional<Weight>(best_hub->first) : std::nullopt);
+            }
+        }
+        return weights;
+    }
+
+    template <typename Weight>
+    size_t HubLabelsRouter<Weight>::GetLabelEntryCount() const {
+        return out_labels_.entries.size() + in_labels_.entries.size();
+    }
+
+    template <typename Weight>
+    transport_catalogue_serialize::HubLabels HubLabelsRouter<Weight>::GetSerializedHubLabels() const {
+        transport_catalogue_serialize::HubLabels hub_labels_serialized;
+        auto serialize_labels = [](const Labels& labels, transport_catalogue_serialize::Labels& labels_serialized) {
+            labels_serialized.mutable_offsets()->Reserve(static_cast<int>(labels.offsets.size()));
+            for (const size_t offset : labels.offsets) {
+                labels_serialized.add_offsets(offset);
+            }
+            const int entry_count = static_cast<int>(labels.entries.size());
+            labels_serialized.mutable_hubs()->Reserve(entry_count);
+            labels_serialized.mutable_weights()->Reserve(entry_count);
+            labels_serialized.mutable_edges()->Reserve(entry_count);
+            for (const LabelEntry& entry : labels.entries) {
+                labels_serialized.add_hubs(entry.hub);
+                labels_serialized.add_weights(entry.weight);
+                labels_serialized.add_edges(entry.edge);
+            }
+        };
+        serialize_labels(out_labels_, *hub_labels_serialized.mutable_out_labels());
+        serialize_labels(in_labels_, *hub_labels_serialized.mutable_in_labels());
+        return hub_labels_serialized;
+    }
+}  // namespace graph
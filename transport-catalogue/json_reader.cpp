@@ -1,5 +1,10 @@
 #include "json_reader.h"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <map>
 #include <stdexcept>
+#include <tuple>
 
 namespace reader {
 
@@ -67,12 +72,92 @@ namespace reader {
         queries.render_settings_ = std::move(set);
     }
 
+    transport_router::EngineType MakeEngineType(const std::string& name) {
+        if (name == "all_pairs") {
+            return transport_router::EngineType::ALL_PAIRS;
+        } else if (name == "dijkstra") {
+            return transport_router::EngineType::DIJKSTRA;
+        } else if (name == "contraction_hierarchies") {
+            return transport_router::EngineType::CONTRACTION_HIERARCHIES;
+        } else if (name == "hub_labels") {
+            return transport_router::EngineType::HUB_LABELS;
+        } else if (name == "alt") {
+            return transport_router::EngineType::ALT;
+        } else if (name == "raptor") {
+            return transport_router::EngineType::RAPTOR;
+        } else if (name == "auto") {
+            return transport_router::EngineType::AUTO;
+        }
+        throw std::logic_error("Unknown routing engine: "s + name);
+    }
+
+    transport_router::GraphModel MakeGraphModel(const std::string& name) {
+        if (name == "complete") {
+            return transport_router::GraphModel::COMPLETE;
+        } else if (name == "trip_based") {
+            return transport_router::GraphModel::TRIP_BASED;
+        }
+        throw std::logic_error("Unknown routing graph model: "s + name);
+    }
+
+    transport_router::WeightType MakeWeightType(const std::string& name) {
+        if (name == "double") {
+            return transport_router::WeightType::DOUBLE;
+        } else if (name == "float") {
+            return transport_router::WeightType::FLOAT;
+        } else if (name == "fixed_point") {
+            return transport_router::WeightType::FIXED_POINT;
+        }
+        throw std::logic_error("Unknown routing weight type: "s + name);
+    }
+
+    // Route requests may override the routing settings' wait time and velocity, each one separately.
+    std::optional<transport_router::RouteMetric> MakeRouteMetric(const json::Dict& query, transport_router::RouteMetric metric) {
+        if (query.count("bus_wait_time") > 0) {
+            metric.bus_wait_time_ = query.at("bus_wait_time").AsDouble();
+        }
+        if (query.count("bus_velocity") > 0) {
+            metric.bus_velocity_ = query.at("bus_velocity").AsDouble();
+        }
+        if (!(metric.bus_velocity_ > 0.0) || metric.bus_wait_time_ < 0.0) {
+            return std::nullopt;
+        }
+        return metric;
+    }
+
     void ParseRoutingSettings(const json::Node& data, MakeBaseRequests& queries) {
         auto& settings = data.AsDict();
         transport_router::RoutingSettings set{
             settings.at("bus_wait_time").AsDouble(),
             settings.at("bus_velocity").AsDouble()
         };
+        if (settings.count("engine") > 0) {
+            set.engine_ = MakeEngineType(settings.at("engine").AsString());
+        }
+        if (settings.count("graph_model") > 0) {
+            set.graph_model_ = MakeGraphModel(settings.at("graph_model").AsString());
+        }
+        if (settings.count("precompute_threads") > 0) {
+            set.precompute_threads_ = static_cast<size_t>(settings.at("precompute_threads").AsInt());
+        }
+        if (settings.count("route_cache_capacity") > 0) {
+            set.route_cache_capacity_ = static_cast<size_t>(settings.at("route_cache_capacity").AsInt());
+        }
+        if (settings.count("weight_type") > 0) {
+            set.weight_type_ = MakeWeightType(settings.at("weight_type").AsString());
+        }
+        if (settings.count("landmark_count") > 0) {
+            set.landmark_count_ = static_cast<size_t>(settings.at("landmark_count").AsInt());
+        }
+        if (settings.count("max_memory_mb") > 0) {
+            set.max_memory_mb_ = settings.at("max_memory_mb").AsDouble();
+        }
+        if (settings.count("max_build_seconds") > 0) {
+            set.max_build_seconds_ = settings.at("max_build_seconds").AsDouble();
+        }
+        if (settings.count("max_transfers") > 0) {
+            set.max_transfers_ = static_cast<size_t>(settings.at("max_transfers").AsInt());
+        }
         queries.routing_settings_ = set;
     }
 
@@ -118,7 +203,7 @@ namespace reader {
         return queries;
     }
 
-    void AddStopsFromJSON(transport_catalogue::TransportCatalogue& transport_catalogue, std::unordered_set<const json::Dict*>& queries) {
+    void AddStopsFromJSON(transport_catalogue::TransportCatalogue& transport_catalogue, const std::vector<const json::Dict*>& queries) {
         for (const json::Dict* query : queries) {
             const std::string stop_name = query->at("name").AsString();
             transport_catalogue.AddStop({
@@ -139,7 +224,7 @@ namespace reader {
         }
     }
 
-    void AddBusesFromJSON(transport_catalogue::TransportCatalogue& transport_catalogue, std::unordered_set<const json::Dict*>& queries) {
+    void AddBusesFromJSON(transport_catalogue::TransportCatalogue& transport_catalogue, const std::vector<const json::Dict*>& queries) {
         for (const json::Dict* query : queries) {
             std::vector<std::string> stops;
             stops.reserve(query->at("stops").AsArray().size());
@@ -154,13 +239,68 @@ namespace reader {
         }
     }
 
+    std::vector<const json::Dict*> SortStopsQueriesAlongHilbertCurve(const std::unordered_set<const json::Dict*>& queries) {
+        if (queries.empty()) return {};
+        geo::Coordinates min{std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+        geo::Coordinates max{std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+        for (const json::Dict* query : queries) {
+            min.lat = std::min(min.lat, query->at("latitude").AsDouble());
+            min.lng = std::min(min.lng, query->at("longitude").AsDouble());
+            max.lat = std::max(max.lat, query->at("latitude").AsDouble());
+            max.lng = std::max(max.lng, query->at("longitude").AsDouble());
+        }
+
+        std::vector<std::pair<uint64_t, const json::Dict*>> indexed_queries;
+        indexed_queries.reserve(queries.size());
+        for (const json::Dict* query : queries) {
+            geo::Coordinates point{query->at("latitude").AsDouble(), query->at("longitude").AsDouble()};
+            indexed_queries.emplace_back(geo::ComputeHilbertIndex(point, min, max), query);
+        }
+        std::sort(indexed_queries.begin(), indexed_queries.end(), [](const auto& lhs, const auto& rhs) {
+            return std::tie(lhs.first, lhs.second->at("name").AsString()) < std::tie(rhs.first, rhs.second->at("name").AsString());
+        });
+
+        std::vector<const json::Dict*> sorted_queries;
+        sorted_queries.reserve(indexed_queries.size());
+        for (const auto& [index, query] : indexed_queries) {
+            sorted_queries.push_back(query);
+        }
+        return sorted_queries;
+    }
+
+    std::vector<const json::Dict*> SortBusesQueriesByFirstStop(const std::unordered_set<const json::Dict*>& queries,
+                                                               const std::vector<const json::Dict*>& sorted_stops_queries) {
+        std::unordered_map<std::string_view, size_t> stop_positions;
+        for (size_t i = 0; i < sorted_stops_queries.size(); ++i) {
+            stop_positions.insert({sorted_stops_queries[i]->at("name").AsString(), i});
+        }
+        auto get_first_stop_position = [&stop_positions](const json::Dict* query) {
+            const json::Array& stops = query->at("stops").AsArray();
+            if (stops.empty() || stop_positions.count(stops.front().AsString()) == 0) {
+                return std::numeric_limits<size_t>::max();
+            }
+            return stop_positions.at(stops.front().AsString());
+        };
+
+        std::vector<const json::Dict*> sorted_queries(queries.begin(), queries.end());
+        std::sort(sorted_queries.begin(), sorted_queries.end(), [&get_first_stop_position](const json::Dict* lhs, const json::Dict* rhs) {
+            const size_t lhs_position = get_first_stop_position(lhs);
+            const size_t rhs_position = get_first_stop_position(rhs);
+            return std::tie(lhs_position, lhs->at("name").AsString()) < std::tie(rhs_position, rhs->at("name").AsString());
+        });
+        return sorted_queries;
+    }
+
+    // Stops are added in Hilbert curve order and buses in the order of their first stops,
+    // so stop ids and graph vertices of neighbouring stops end up close together in every array.
     void FillTransportCatalogue(transport_catalogue::TransportCatalogue& transport_catalogue,
                 std::unordered_set<const json::Dict*>& stop_queries,
                 std::unordered_set<const json::Dict*>& bus_queries)
     {
-        AddStopsFromJSON(transport_catalogue, stop_queries);
+        const std::vector<const json::Dict*> sorted_stop_queries = SortStopsQueriesAlongHilbertCurve(stop_queries);
+        AddStopsFromJSON(transport_catalogue, sorted_stop_queries);
         AddStopsDistancesFromJSON(transport_catalogue, stop_queries);
-        AddBusesFromJSON(transport_catalogue, bus_queries);
+        AddBusesFromJSON(transport_catalogue, SortBusesQueriesByFirstStop(bus_queries, sorted_stop_queries));
     }
 
     json::Node ProcessStopQuery(RequestHandler& request_handler, const json::Dict* query) {
@@ -187,20 +327,131 @@ namespace reader {
         return MakeJSONMapResponse(str.str(), query);
     }
 
-    json::Node ProcessRouteQuery(RequestHandler& request_handler, const json::Dict* query) {
-        auto route_description =
-                request_handler.BuildOptimalRoute(query->at("from").AsString(), query->at("to").AsString());
+    json::Node ProcessMatrixQuery(RequestHandler& request_handler, const json::Dict* query) {
+        auto make_stops = [](const json::Array& stop_nodes) {
+            std::vector<std::string_view> stops;
+            stops.reserve(stop_nodes.size());
+            for (const auto& stop_node : stop_nodes) {
+                stops.push_back(stop_node.AsString());
+            }
+            return stops;
+        };
+        return MakeJSONMatrixResponse(request_handler.BuildTimeMatrix(make_stops(query->at("sources").AsArray()),
+                                                                      make_stops(query->at("targets").AsArray())),
+                                      query);
+    }
 
-        if (!route_description.has_value()) {
+    json::Node ProcessIsochroneQuery(RequestHandler& request_handler, const json::Dict* query) {
+        auto isochrone = request_handler.BuildIsochrone(query->at("stop_name").AsString(),
+                                                        query->at("max_time").AsDouble());
+        if (!isochrone.has_value()) {
             return MakeErrorResponse(query);
         } else {
-            return MakeJSONRouteResponse(route_description.value(), query);
+            return MakeJSONIsochroneResponse(isochrone.value(), query);
         }
     }
 
+    json::Node ProcessNearbyStopsQuery(RequestHandler& request_handler, const json::Dict* query) {
+        std::optional<double> radius;
+        std::optional<size_t> count;
+        if (query->count("radius") > 0) {
+            radius = query->at("radius").AsDouble();
+            if (*radius < 0.0) {
+                return MakeErrorResponse(query, "invalid radius");
+            }
+        }
+        if (query->count("count") > 0) {
+            const int value = query->at("count").AsInt();
+            if (value < 0) {
+                return MakeErrorResponse(query, "invalid count");
+            }
+            count = static_cast<size_t>(value);
+        }
+        if (!radius.has_value() && !count.has_value()) {
+            return MakeErrorResponse(query, "radius or count required");
+        }
+        geo::Coordinates point{query->at("latitude").AsDouble(), query->at("longitude").AsDouble()};
+        return MakeJSONNearbyStopsResponse(request_handler.FindNearbyStops(point, radius, count), query);
+    }
+
+    // A route end is either a stop name or a point {"latitude", "longitude"} standing for the stop nearest to it.
+    std::optional<std::string_view> MakeRouteStop(RequestHandler& request_handler, const json::Node& node) {
+        if (node.IsString()) {
+            return node.AsString();
+        }
+        const json::Dict& point = node.AsDict();
+        auto stops = request_handler.FindNearbyStops({point.at("latitude").AsDouble(), point.at("longitude").AsDouble()},
+                                                     std::nullopt, 1);
+        if (stops.empty()) {
+            return std::nullopt;
+        }
+        return stops.front().name_;
+    }
+
+    // Route queries are grouped by their origin and metric and answered one group at a time,
+    // so each group costs a single search no matter how many destinations it has.
+    std::unordered_map<const json::Dict*, json::Node> ProcessRouteQueries(RequestHandler& request_handler,
+                                                                          const std::vector<const json::Dict*>& stat_queries) {
+        using RouteGroup = std::tuple<std::string_view, double, double>;
+        const transport_router::RouteMetric default_metric = request_handler.GetRouteMetric();
+        std::vector<RouteGroup> groups;
+        std::map<RouteGroup, std::vector<std::pair<const json::Dict*, std::string_view>>> queries_by_group;
+        std::unordered_map<const json::Dict*, json::Node> responses;
+        for (const json::Dict* query : stat_queries) {
+            if (query->at("type").AsString() != "Route") continue;
+            const std::optional<std::string_view> stop_from = MakeRouteStop(request_handler, query->at("from"));
+            const std::optional<std::string_view> stop_to = MakeRouteStop(request_handler, query->at("to"));
+            if (!stop_from.has_value() || !stop_to.has_value()) {
+                responses.emplace(query, MakeErrorResponse(query));
+                continue;
+            }
+            const std::optional<transport_router::RouteMetric> metric = MakeRouteMetric(*query, default_metric);
+            if (!metric.has_value()) {
+                responses.emplace(query, MakeErrorResponse(query, "invalid bus_wait_time or bus_velocity"));
+                continue;
+            }
+            RouteGroup group{*stop_from, metric->bus_wait_time_, metric->bus_velocity_};
+            auto& queries = queries_by_group[group];
+            if (queries.empty()) {
+                groups.push_back(group);
+            }
+            queries.emplace_back(query, *stop_to);
+        }
+
+        for (const RouteGroup& group : groups) {
+            const auto& [stop_from, bus_wait_time, bus_velocity] = group;
+            const auto& queries = queries_by_group.at(group);
+            std::vector<std::string_view> stops_to;
+            stops_to.reserve(queries.size());
+            for (const auto& [query, stop_to] : queries) {
+                stops_to.push_back(stop_to);
+            }
+            auto route_descriptions = request_handler.BuildOptimalRoutes(stop_from, stops_to, {bus_wait_time, bus_velocity});
+            for (size_t i = 0; i < queries.size(); ++i) {
+                const json::Dict* query = queries[i].first;
+                if (route_descriptions[i] == nullptr) {
+                    responses.emplace(query, MakeErrorResponse(query));
+                } else {
+                    responses.emplace(query, MakeJSONRouteResponse(*route_descriptions[i], query));
+                }
+            }
+        }
+        return responses;
+    }
+
+    // Route queries are batched up to the next RoutingStatistics query, so it counts only the queries before it.
     json::Document ProcessStatRequests(RequestHandler& request_handler, std::vector<const json::Dict*>& stat_queries) {
+        auto is_statistics_query = [](const json::Dict* query) {
+            return query->at("type").AsString() == "RoutingStatistics";
+        };
+        std::unordered_map<const json::Dict*, json::Node> route_responses;
         json::Array array;
-        for (auto query : stat_queries) {
+        for (auto it = stat_queries.begin(); it != stat_queries.end(); ++it) {
+            const json::Dict* query = *it;
+            if (it == stat_queries.begin() || is_statistics_query(*std::prev(it))) {
+                route_responses = ProcessRouteQueries(request_handler,
+                                                      {it, std::find_if(it, stat_queries.end(), is_statistics_query)});
+            }
             if (query->at("type").AsString() == "Stop") {
                 array.push_back(ProcessStopQuery(request_handler, query));
             } else if (query->at("type").AsString() == "Bus") {
@@ -208,7 +459,16 @@ namespace reader {
             } else if (query->at("type").AsString() == "Map") {
                 array.push_back(ProcessMapQuery(request_handler, query));
             } else if (query->at("type").AsString() == "Route") {
-                array.push_back(ProcessRouteQuery(request_handler, query));
+                array.push_back(std::move(route_responses.at(query)));
+            } else if (query->at("type").AsString() == "Matrix") {
+                array.push_back(ProcessMatrixQuery(request_handler, query));
+            } else if (query->at("type").AsString() == "Isochrone") {
+                array.push_back(ProcessIsochroneQuery(request_handler, query));
+            } else if (query->at("type").AsString() == "NearbyStops") {
+                array.push_back(ProcessNearbyStopsQuery(request_handler, query));
+            } else if (query->at("type").AsString() == "RoutingStatistics") {
+                array.push_back(MakeJSONRoutingStatisticsResponse(request_handler.GetRouteCacheStatistics(),
+                                                                  request_handler.GetSearchStatistics(), query));
             }
         }
         json::Document doc(array);
@@ -7,6 +7,7 @@
 #include "transport_router.h"
 #include "serialization.h"
 #include <vector>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
@@ -40,13 +41,21 @@ namespace reader {
     void ParseStatRequests(const json::Node& data, ProcessRequests& queries);
     void ParseRenderSettings(const json::Node& data, MakeBaseRequests& queries);
     void ParseRoutingSettings(const json::Node& data, MakeBaseRequests& queries);
+    transport_router::EngineType MakeEngineType(const std::string& name);
+    transport_router::GraphModel MakeGraphModel(const std::string& name);
+    transport_router::WeightType MakeWeightType(const std::string& name);
+    // Nullopt if the query sets a velocity that isn't positive or a negative wait time.
+    std::optional<transport_router::RouteMetric> MakeRouteMetric(const json::Dict& query, transport_router::RouteMetric metric);
 
     MakeBaseRequests ParseMakeBaseJSON(json::Document& doc);
     ProcessRequests ParseProcessRequestsJSON(json::Document& doc);
 
-    void AddStopsFromJSON(transport_catalogue::TransportCatalogue& transport_catalogue, std::unordered_set<const json::Dict*>& queries);
+    void AddStopsFromJSON(transport_catalogue::TransportCatalogue& transport_catalogue, const std::vector<const json::Dict*>& queries);
     void AddStopsDistancesFromJSON(transport_catalogue::TransportCatalogue& transport_catalogue, std::unordered_set<const json::Dict*>& queries);
-    void AddBusesFromJSON(transport_catalogue::TransportCatalogue& transport_catalogue, std::unordered_set<const json::Dict*>& queries);
+    void AddBusesFromJSON(transport_catalogue::TransportCatalogue& transport_catalogue, const std::vector<const json::Dict*>& queries);
+    std::vector<const json::Dict*> SortStopsQueriesAlongHilbertCurve(const std::unordered_set<const json::Dict*>& queries);
+    std::vector<const json::Dict*> SortBusesQueriesByFirstStop(const std::unordered_set<const json::Dict*>& queries,
+                                                               const std::vector<const json::Dict*>& sorted_stops_queries);
 
     svg::Point MakeOffset(const json::Array& values);
     svg::Color MakeColorForSVG(const json::Node& node);
@@ -58,6 +67,11 @@ namespace reader {
 
     json::Node ProcessStopQuery(RequestHandler& request_handler, const json::Dict* query);
     json::Node ProcessBusQuery(RequestHandler& request_handler, const json::Dict* query);
-    json::Node ProcessRouteQuery(RequestHandler& request_handler, const json::Dict* query);
+    json::Node ProcessMatrixQuery(RequestHandler& request_handler, const json::Dict* query);
+    json::Node ProcessIsochroneQuery(RequestHandler& request_handler, const json::Dict* query);
+    json::Node ProcessNearbyStopsQuery(RequestHandler& request_handler, const json::Dict* query);
+    std::optional<std::string_view> MakeRouteStop(RequestHandler& request_handler, const json::Node& node);
+    std::unordered_map<const json::Dict*, json::Node> ProcessRouteQueries(RequestHandler& request_handler,
+                                                                          const std::vector<const json::Dict*>& stat_queries);
     json::Document ProcessStatRequests(RequestHandler& request_handler, std::vector<const json::Dict*>& stat_queries);
 }
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdlib>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace cache {
+
+    struct CacheStatistics {
+        size_t hits_ = 0;
+        size_t misses_ = 0;
+        size_t size_ = 0;
+    };
+
+    // Bounded thread-safe cache which evicts the least recently used entry first.
+    // A cache with zero capacity stores nothing and only counts misses.
+    template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+    class LruCache {
+    public:
+        explicit LruCache(size_t capacity) : capacity_(capacity) {}
+
+        std::optional<Value> Get(const Key& key) {
+            std::lock_guard lock(mutex_);
+            auto it = index_.find(key);
+            if (it == index_.end()) {
+                ++statistics_.misses_;
+                return std::nullopt;
+            }
+            ++statistics_.hits_;
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return it->second->second;
+        }
+
+        void Put(const Key& key, Value value) {
+            if (capacity_ == 0) {
+                return;
+            }
+            std::lock_guard lock(mutex_);
+            auto it = index_.find(key);
+            if (it != index_.end()) {
+                it->second->second = std::move(value);
+                entries_.splice(entries_.begin(), entries_, it->second);
+                return;
+            }
+            if (entries_.size() == capacity_) {
+                index_.erase(entries_.back().first);
+                entries_.pop_back();
+            }
+            entries_.emplace_front(key, std::move(value));
+            index_.emplace(key, entries_.begin());
+        }
+
+        size_t GetCapacity() const {
+            return capacity_;
+        }
+
+        CacheStatistics GetStatistics() const {
+            std::lock_guard lock(mutex_);
+            CacheStatistics statistics = statistics_;
+            statistics.size_ = entries_.size();
+            return statistics;
+        }
+
+    private:
+        using Entries = std::list<std::pair<Key, Value>>;
+
+        size_t capacity_;
+        mutable std::mutex mutex_;
+        Entries entries_;
+        std::unordered_map<Key, typename Entries::iterator, Hasher> index_;
+        CacheStatistics statistics_;
+    };
+}  // namespace cache
@@ -12,6 +12,17 @@ void PrintUsage(std::ostream& stream = std::cerr) {
     stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
 }
 
+void PrintEngineSelection(const transport_router::TransportRouter& transport_router, std::ostream& stream = std::cerr) {
+    const auto& settings = transport_router.GetRoutingSettings();
+    stream << "auto engine: "sv << transport_router::GetEngineName(settings.engine_)
+           << " (budget "sv << settings.max_memory_mb_ << " MB, "sv << settings.max_build_seconds_ << " s)\n"sv;
+    for (const auto& estimate : transport_router.GetEngineEstimates()) {
+        stream << "  "sv << transport_router::GetEngineName(estimate.engine_) << ": "sv
+               << estimate.memory_mb_ << " MB, "sv << estimate.build_seconds_ << " s"sv
+               << (estimate.fits_ ? ""sv : ", over budget"sv) << '\n';
+    }
+}
+
 int main(int argc, char* argv[]) {
     if (argc != 2) {
         PrintUsage();
@@ -26,10 +37,15 @@ int main(int argc, char* argv[]) {
         auto doc{reader::ReadJSON(std::cin)};
         auto queries{reader::ParseMakeBaseJSON(doc)};
         reader::FillTransportCatalogue(transport_catalogue, queries.stops_queries_, queries.buses_queries_);
+        transport_catalogue::FrozenTransportCatalogue frozen_transport_catalogue{transport_catalogue};
         transport_router::TransportRouter transport_router{queries.routing_settings_, transport_catalogue};
+        if (!transport_router.GetEngineEstimates().empty()) {
+            PrintEngineSelection(transport_router);
+        }
 
         std::ofstream out_file(queries.serialization_settings_.file_name_, std::ios::binary);
-        serialization::EntitiesForSerialization entities{transport_catalogue, queries.render_settings_, transport_router};
+        serialization::EntitiesForSerialization entities{transport_catalogue, frozen_transport_catalogue,
+                                                         queries.render_settings_, transport_router};
         serialization::SerializeTransportDataBase(entities, out_file);
 
     } else if (mode == "process_requests"sv) {
@@ -40,7 +56,7 @@ int main(int argc, char* argv[]) {
         std::ifstream in_file(queries.serialization_settings_.file_name_, std::ios::binary);
         serialization::DataBase db = serialization::DeserializeTransportDataBase(in_file);
 
-        RequestHandler request_handler{db.transport_catalogue_, db.render_settings_, db.transport_router_};
+        RequestHandler request_handler{db.frozen_transport_catalogue_, db.render_settings_, db.transport_router_};
 
         json::Document response{reader::ProcessStatRequests(request_handler, queries.stat_requests_)};
         json::Print(response, std::cout);
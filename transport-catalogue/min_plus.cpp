@@ -0,0 +1,173 @@
+#include "min_plus.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MIN_PLUS_X86
+#include <immintrin.h>
+#endif
+
+namespace min_plus {
+
+    namespace {
+        template <typename MatrixWeight>
+        void RelaxRowScalar(const MatrixWeight* through, const uint32_t* prev_through, MatrixWeight* row, uint32_t* prev_row,
+                            size_t begin, size_t count, MatrixWeight weight_from, uint32_t prev_edge_from, uint32_t no_edge) {
+            for (size_t i = begin; i < count; ++i) {
+                const MatrixWeight candidate_weight = weight_from + through[i];
+                if (candidate_weight < row[i]) {
+                    row[i] = candidate_weight;
+                    prev_row[i] = prev_through[i] != no_edge ? prev_through[i] : prev_edge_from;
+                }
+            }
+        }
+
+#ifdef MIN_PLUS_X86
+        __attribute__((target("sse4.1")))
+        size_t RelaxRowSse41(const float* through, const uint32_t* prev_through, float* row, uint32_t* prev_row,
+                             size_t count, float weight_from, uint32_t prev_edge_from, uint32_t no_edge) {
+            const __m128 weight_from_lanes = _mm_set1_ps(weight_from);
+            const __m128i prev_edge_from_lanes = _mm_set1_epi32(static_cast<int>(prev_edge_from));
+            const __m128i no_edge_lanes = _mm_set1_epi32(static_cast<int>(no_edge));
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const __m128 candidate = _mm_add_ps(weight_from_lanes, _mm_loadu_ps(through + i));
+                const __m128 current = _mm_loadu_ps(row + i);
+                const __m128i improved = _mm_castps_si128(_mm_cmplt_ps(candidate, current));
+                const __m128i prev_through_lanes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_through + i));
+                const __m128i prev_candidate = _mm_blendv_epi8(prev_through_lanes, prev_edge_from_lanes,
+                                                               _mm_cmpeq_epi32(prev_through_lanes, no_edge_lanes));
+                const __m128i prev_current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_row + i));
+                _mm_storeu_ps(row + i, _mm_blendv_ps(current, candidate, _mm_castsi128_ps(improved)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(prev_row + i), _mm_blendv_epi8(prev_current, prev_candidate, improved));
+            }
+            return i;
+        }
+
+        __attribute__((target("sse4.1")))
+        size_t RelaxRowSse41(const uint32_t* through, const uint32_t* prev_through, uint32_t* row, uint32_t* prev_row,
+                             size_t count, uint32_t weight_from, uint32_t prev_edge_from, uint32_t no_edge) {
+            const __m128i weight_from_lanes = _mm_set1_epi32(static_cast<int>(weight_from));
+            const __m128i prev_edge_from_lanes = _mm_set1_epi32(static_cast<int>(prev_edge_from));
+            const __m128i no_edge_lanes = _mm_set1_epi32(static_cast<int>(no_edge));
+            const __m128i all_ones = _mm_set1_epi32(-1);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const __m128i candidate = _mm_add_epi32(weight_from_lanes,
+                                                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(through + i)));
+                const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+                const __m128i minimum = _mm_min_epu32(candidate, current);
+                const __m128i improved = _mm_xor_si128(_mm_cmpeq_epi32(minimum, current), all_ones);
+                const __m128i prev_through_lanes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_through + i));
+                const __m128i prev_candidate = _mm_blendv_epi8(prev_through_lanes, prev_edge_from_lanes,
+                                                               _mm_cmpeq_epi32(prev_through_lanes, no_edge_lanes));
+                const __m128i prev_current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_row + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), minimum);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(prev_row + i), _mm_blendv_epi8(prev_current, prev_candidate, improved));
+            }
+            return i;
+        }
+
+        __attribute__((target("avx2")))
+        size_t RelaxRowAvx2(const float* through, const uint32_t* prev_through, float* row, uint32_t* prev_row,
+                            size_t count, float weight_from, uint32_t prev_edge_from, uint32_t no_edge) {
+            const __m256 weight_from_lanes = _mm256_set1_ps(weight_from);
+            const __m256i prev_edge_from_lanes = _mm256_set1_epi32(static_cast<int>(prev_edge_from));
+            const __m256i no_edge_lanes = _mm256_set1_epi32(static_cast<int>(no_edge));
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                const __m256 candidate = _mm256_add_ps(weight_from_lanes, _mm256_loadu_ps(through + i));
+                const __m256 current = _mm256_loadu_ps(row + i);
+                const __m256i improved = _mm256_castps_si256(_mm256_cmp_ps(candidate, current, _CMP_LT_OQ));
+                const __m256i prev_through_lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_through + i));
+                const __m256i prev_candidate = _mm256_blendv_epi8(prev_through_lanes, prev_edge_from_lanes,
+                                                                  _mm256_cmpeq_epi32(prev_through_lanes, no_edge_lanes));
+                const __m256i prev_current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_row + i));
+                _mm256_storeu_ps(row + i, _mm256_blendv_ps(current, candidate, _mm256_castsi256_ps(improved)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(prev_row + i), _mm256_blendv_epi8(prev_current, prev_candidate, improved));
+            }
+            return i;
+        }
+
+        __attribute__((target("avx2")))
+        size_t RelaxRowAvx2(const uint32_t* through, const uint32_t* prev_through, uint32_t* row, uint32_t* prev_row,
+                            size_t count, uint32_t weight_from, uint32_t prev_edge_from, uint32_t no_edge) {
+            const __m256i weight_from_lanes = _mm256_set1_epi32(static_cast<int>(weight_from));
+            const __m256i prev_edge_from_lanes = _mm256_set1_epi32(static_cast<int>(prev_edge_from));
+            const __m256i no_edge_lanes = _mm256_set1_epi32(static_cast<int>(no_edge));
+            const __m256i all_ones = _mm256_set1_epi32(-1);
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                const __m256i candidate = _mm256_add_epi32(weight_from_lanes,
+                                                           _mm256_loadu_si256(reinterpret_cast<const __m256i*>(through + i)));
+                const __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+                const __m256i minimum = _mm256_min_epu32(candidate, current);
+                const __m256i improved = _mm256_xor_si256(_mm256_cmpeq_epi32(minimum, current), all_ones);
+                const __m256i prev_through_lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_through + i));
+                const __m256i prev_candidate = _mm256_blendv_epi8(prev_through_lanes, prev_edge_from_lanes,
+                                                                  _mm256_cmpeq_epi32(prev_through_lanes, no_edge_lanes));
+                const __m256i prev_current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_row + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(row + i), minimum);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(prev_row + i), _mm256_blendv_epi8(prev_current, prev_candidate, improved));
+            }
+            return i;
+        }
+#endif
+
+        InstructionSet DetectInstructionSet() {
+#ifdef MIN_PLUS_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) {
+                return InstructionSet::AVX2;
+            }
+            if (__builtin_cpu_supports("sse4.1")) {
+                return InstructionSet::SSE41;
+            }
+#endif
+            return InstructionSet::SCALAR;
+        }
+
+        template <typename MatrixWeight>
+        void RelaxRowDispatched([[maybe_unused]] InstructionSet instruction_set, const MatrixWeight* through,
+                                const uint32_t* prev_through, MatrixWeight* row, uint32_t* prev_row,
+                                size_t count, MatrixWeight weight_from, uint32_t prev_edge_from, uint32_t no_edge) {
+            size_t done = 0;
+#ifdef MIN_PLUS_X86
+            switch (instruction_set) {
+                case InstructionSet::AVX2:
+                    done = RelaxRowAvx2(through, prev_through, row, prev_row, count, weight_from, prev_edge_from, no_edge);
+                    break;
+                case InstructionSet::SSE41:
+                    done = RelaxRowSse41(through, prev_through, row, prev_row, count, weight_from, prev_edge_from, no_edge);
+                    break;
+                case InstructionSet::SCALAR:
+                    break;
+            }
+#endif
+            RelaxRowScalar(through, prev_through, row, prev_row, done, count, weight_from, prev_edge_from, no_edge);
+        }
+    }  // namespace
+
+    InstructionSet GetInstructionSet() {
+        static const InstructionSet instruction_set = DetectInstructionSet();
+        return instruction_set;
+    }
+
+    void RelaxRow(const float* through, const uint32_t* prev_through, float* row, uint32_t* prev_row,
+                  size_t count, float weight_from, uint32_t prev_edge_from, uint32_t no_edge) {
+        RelaxRowDispatched(GetInstructionSet(), through, prev_through, row, prev_row, count, weight_from, prev_edge_from, no_edge);
+    }
+
+    void RelaxRow(const uint32_t* through, const uint32_t* prev_through, uint32_t* row, uint32_t* prev_row,
+                  size_t count, uint32_t weight_from, uint32_t prev_edge_from, uint32_t no_edge) {
+        RelaxRowDispatched(GetInstructionSet(), through, prev_through, row, prev_row, count, weight_from, prev_edge_from, no_edge);
+    }
+
+    void RelaxRow(InstructionSet instruction_set, const float* through, const uint32_t* prev_through, float* row,
+                  uint32_t* prev_row, size_t count, float weight_from, uint32_t prev_edge_from, uint32_t no_edge) {
+        RelaxRowDispatched(instruction_set, through, prev_through, row, prev_row, count, weight_from, prev_edge_from, no_edge);
+    }
+
+    void RelaxRow(InstructionSet instruction_set, const uint32_t* through, const uint32_t* prev_through, uint32_t* row,
+                  uint32_t* prev_row, size_t count, uint32_t weight_from, uint32_t prev_edge_from, uint32_t no_edge) {
+        RelaxRowDispatched(instruction_set, through, prev_through, row, prev_row, count, weight_from, prev_edge_from, no_edge);
+    }
+}  // namespace min_plus
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace min_plus {
+
+    enum class InstructionSet {
+        SCALAR,
+        SSE41,
+        AVX2
+    };
+
+    // The widest kernel the CPU supports, detected once on first use.
+    InstructionSet GetInstructionSet();
+
+    // Relaxes one row of an all-pairs matrix through an intermediate vertex:
+    // row[i] = min(row[i], weight_from + through[i]). Where a cell improves, its previous edge becomes
+    // prev_through[i], or prev_edge_from if that cell has none (no_edge).
+    // Unreachable cells must hold a value whose sum with weight_from can't beat any real weight:
+    // infinity for float, half of the range for uint32_t.
+    void RelaxRow(const float* through, const uint32_t* prev_through, float* row, uint32_t* prev_row,
+                  size_t count, float weight_from, uint32_t prev_edge_from, uint32_t no_edge);
+    void RelaxRow(const uint32_t* through, const uint32_t* prev_through, uint32_t* row, uint32_t* prev_row,
+                  size_t count, uint32_t weight_from, uint32_t prev_edge_from, uint32_t no_edge);
+    // The same with the kernel of the given instruction set, which the CPU has to support.
+    void RelaxRow(InstructionSet instruction_set, const float* through, const uint32_t* prev_through, float* row,
+                  uint32_t* prev_row, size_t count, float weight_from, uint32_t prev_edge_from, uint32_t no_edge);
+    void RelaxRow(InstructionSet instruction_set, const uint32_t* through, const uint32_t* prev_through, uint32_t* row,
+                  uint32_t* prev_row, size_t count, uint32_t weight_from, uint32_t prev_edge_from, uint32_t no_edge);
+}  // namespace min_plus
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace perfect_hash {
+
+    inline uint64_t Mix(uint64_t value) {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdULL;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ULL;
+        value ^= value >> 33;
+        return value;
+    }
+
+    // Little-endian on any host, so stored seeds stay valid.
+    inline uint64_t HashName(std::string_view name) {
+        constexpr uint64_t MULTIPLIER = 0x9e3779b97f4a7c15ULL;
+        uint64_t hash = name.size() * MULTIPLIER;
+        size_t i = 0;
+        for (; i + 8 <= name.size(); i += 8) {
+            uint64_t word;
+            std::memcpy(&word, name.data() + i, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            word = __builtin_bswap64(word);
+#endif
+            hash = (hash ^ word) * MULTIPLIER;
+            hash ^= hash >> 29;
+        }
+        uint64_t tail = 0;
+        for (size_t byte = 0; i + byte < name.size(); ++byte) {
+            tail |= static_cast<uint64_t>(static_cast<unsigned char>(name[i + byte])) << (8 * byte);
+        }
+        return Mix(hash ^ tail);
+    }
+
+    // Minimal perfect hash over distinct names (hash and displace).
+    class NameIndex {
+    public:
+        static constexpr uint32_t NOT_FOUND = std::numeric_limits<uint32_t>::max();
+
+        NameIndex() = default;
+        // Find(names[i]) returns ids[i].
+        NameIndex(const std::vector<std::string_view>& names, const std::vector<uint32_t>& ids);
+        // From stored seeds and the names and ids in slot order.
+        NameIndex(std::vector<uint32_t> seeds, const std::vector<std::string_view>& slot_names,
+                  std::vector<uint32_t> slot_ids);
+
+        uint32_t Find(std::string_view name) const;
+        size_t GetSize() const;
+        const std::vector<uint32_t>& GetSeeds() const &;
+        const std::vector<uint32_t>& GetSlotIds() const &;
+
+    private:
+        static constexpr size_t NAMES_PER_BUCKET = 4;
+        static constexpr uint32_t MAX_SEED = 1u << 24;
+
+        std::vector<uint32_t> seeds_;
+        std::string pool_;
+        // Slot i holds pool_[name_offsets_[i], name_offsets_[i + 1]).
+        std::vector<uint32_t> name_offsets_;
+        std::vector<uint32_t> slot_ids_;
+
+        size_t GetBucket(uint64_t hash) const;
+        size_t GetSlot(uint64_t hash, uint32_t seed) const;
+        void FillPool(const std::vector<std::string_view>& slot_names);
+    };
+
+    inline NameIndex::NameIndex(const std::vector<std::string_view>& names, const std::vector<uint32_t>& ids)
+            : seeds_(names.empty() ? 0 : (names.size() + NAMES_PER_BUCKET - 1) / NAMES_PER_BUCKET, 0)
+            , slot_ids_(names.size(), NOT_FOUND)
+    {
+        if (names.size() != ids.size()) {
+            throw std::invalid_argument("Every name of the index needs an id");
+        }
+        std::vector<uint64_t> hashes(names.size());
+        std::vector<std::vector<uint32_t>> buckets(seeds_.size());
+        for (uint32_t name = 0; name < names.size(); ++name) {
+            hashes[name] = HashName(names[name]);
+            buckets[GetBucket(hashes[name])].push_back(name);
+        }
+        // Largest buckets first.
+        std::vector<uint32_t> bucket_order(buckets.size());
+        std::iota(bucket_order.begin(), bucket_order.end(), 0);
+        std::stable_sort(bucket_order.begin(), bucket_order.end(), [&buckets](uint32_t lhs, uint32_t rhs) {
+            return buckets[lhs].size() > buckets[rhs].size();
+        });
+
+        std::vector<std::string_view> slot_names(names.size());
+        std::vector<uint32_t> slots;
+        for (uint32_t bucket : bucket_order) {
+            const std::vector<uint32_t>& bucket_names = buckets[bucket];
+            if (bucket_names.empty()) break;
+            for (size_t i = 0; i < bucket_names.size(); ++i) {
+                for (size_t j = 0; j < i; ++j) {
+                    if (names[bucket_names[i]] == names[bucket_names[j]]) {
+                        throw std::invalid_argument(std::string("Duplicate name in the index: ").append(names[bucket_names[i]]));
+                    }
+                }
+            }
+            for (uint32_t seed = 0;; ++seed) {
+                if (seed == MAX_SEED) {
+                    throw std::runtime_error("No seed places the names of a bucket apart");
+                }
+                slots.clear();
+                for (uint32_t name : bucket_names) {
+                    const size_t slot = GetSlot(hashes[name], seed);
+                    if (slot_ids_[slot] != NOT_FOUND || std::find(slots.begin(), slots.end(), slot) != slots.end()) break;
+                    slots.push_back(slot);
+                }
+                if (slots.size() == bucket_names.size()) {
+                    seeds_[bucket] = seed;
+                    break;
+                }
+            }
+            for (size_t i = 0; i < slots.size(); ++i) {
+                slot_ids_[slots[i]] = ids[bucket_names[i]];
+                slot_names[slots[i]] = names[bucket_names[i]];
+            }
+        }
+        FillPool(slot_names);
+    }
+
+    inline NameIndex::NameIndex(std::vector<uint32_t> seeds, const std::vector<std::string_view>& slot_names,
+                                std::vector<uint32_t> slot_ids)
+            : seeds_(std::move(seeds))
+            , slot_ids_(std::move(slot_ids))
+    {
+        if (slot_names.size() != slot_ids_.size() || seeds_.size() != (slot_ids_.size() + NAMES_PER_BUCKET - 1) / NAMES_PER_BUCKET) {
+            throw std::invalid_argument("Name index parts don't match each other");
+        }
+        FillPool(slot_names);
+    }
+
+    inline uint32_t NameIndex::Find(std::string_view name) const {
+        if (slot_ids_.empty()) return NOT_FOUND;
+        const uint64_t hash = HashName(name);
+        const size_t slot = GetSlot(hash, seeds_[GetBucket(hash)]);
+        const std::string_view slot_name(pool_.data() + name_offsets_[slot], name_offsets_[slot + 1] - name_offsets_[slot]);
+        return slot_name == name ? slot_ids_[slot] : NOT_FOUND;
+    }
+
+    inline size_t NameIndex::GetSize() const {
+        return slot_ids_.size();
+    }
+
+    inline const std::vector<uint32_t>& NameIndex::GetSeeds() const & {
+        return seeds_;
+    }
+
+    inline const std::vector<uint32_t>& NameIndex::GetSlotIds() const & {
+        return slot_ids_;
+    }
+
+    inline size_t NameIndex::GetBucket(uint64_t hash) const {
+        return (hash >> 32) % seeds_.size();
+    }
+
+    inline size_t NameIndex::GetSlot(uint64_t hash, uint32_t seed) const {
+        return Mix(hash + (seed + 1ULL) * 0x9e3779b97f4a7c15ULL) % slot_ids_.size();
+    }
+
+    inline void NameIndex::FillPool(const std::vector<std::string_view>& slot_names) {
+        size_t pool_size = 0;
+        for (std::string_view name : slot_names) {
+            pool_size += name.size();
+        }
+        pool_.reserve(pool_size);
+        name_offsets_.reserve(slot_names.size() + 1);
+        name_offsets_.push_back(0);
+        for (std::string_view name : slot_names) {
+            pool_.append(name);
+            name_offsets_.push_back(static_cast<uint32_t>(pool_.size()));
+        }
+    }
+}  // namespace perfect_hash
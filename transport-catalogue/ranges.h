@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <iterator>
 #include <string_view>
 #include <unordered_map>
@@ -33,4 +34,45 @@ auto AsRange(const C& container) {
     return Range{container.begin(), container.end()};
 }
 
+// Yields consecutive integers, so a half-open interval of ids can be iterated like a container.
+template <typename Integer>
+class CountingIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Integer;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Integer*;
+    using reference = Integer;
+
+    explicit CountingIterator(Integer value)
+        : value_(value) {
+    }
+    Integer operator*() const {
+        return value_;
+    }
+    CountingIterator& operator++() {
+        ++value_;
+        return *this;
+    }
+    CountingIterator operator++(int) {
+        CountingIterator previous = *this;
+        ++value_;
+        return previous;
+    }
+    bool operator==(const CountingIterator& other) const {
+        return value_ == other.value_;
+    }
+    bool operator!=(const CountingIterator& other) const {
+        return value_ != other.value_;
+    }
+
+private:
+    Integer value_;
+};
+
+template <typename Integer>
+auto AsCountingRange(Integer begin, Integer end) {
+    return Range{CountingIterator<Integer>(begin), CountingIterator<Integer>(end)};
+}
+
 }  // namespace ranges
\ No newline at end of file
@@ -0,0 +1,271 @@
+#pragma once
+
+#include "domain.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace raptor {
+
+    using StopIndex = uint32_t;
+
+    // A ride of bus bus_index over span_count stops from position first_stop of its traversal, boarded at board_stop.
+    struct Leg {
+        uint32_t bus_index;
+        uint32_t first_stop;
+        uint32_t span_count;
+        StopIndex board_stop;
+    };
+
+    struct Journey {
+        double time;
+        std::vector<Leg> legs;
+    };
+
+    // The ride that improved a stop in some round: the pattern, boarded and alighted at these positions of it.
+    // previous is the label of the same stop from an earlier round.
+    struct Label {
+        uint32_t pattern;
+        uint32_t board_position;
+        uint32_t alight_position;
+        uint32_t round;
+        uint32_t previous;
+    };
+
+    // Arrivals are the best of all rounds. The labels of a stop form a chain from its last round backwards,
+    // so a route is read back from the stop's label of the round before the ride that left it.
+    struct SearchTree {
+        static constexpr uint32_t NO_LABEL = std::numeric_limits<uint32_t>::max();
+
+        StopIndex from;
+        std::vector<double> arrivals;
+        std::vector<Label> labels;
+        std::vector<uint32_t> last_labels;
+    };
+
+    // Round-based public transit routing (RAPTOR) straight over the stop sequences of the buses, with no routing graph.
+    // Every direction of a bus is a pattern: round k scans the patterns through the stops improved in round k - 1
+    // and rides each of them from the best stop to board, so a route found in round k takes k buses. Buses run
+    // with a fixed wait instead of timetables, thus the best boarding stop is the one with the earliest departure
+    // and the arrivals reach the graph engines' optimum once a round improves nothing.
+    class RaptorRouter {
+    public:
+        static constexpr double UNREACHABLE_TIME = std::numeric_limits<double>::infinity();
+        static constexpr size_t UNLIMITED_TRANSFERS = std::numeric_limits<size_t>::max();
+
+        // Stops are numbered as in stop_names, every stop of the buses must be among them. bus_distance(bus_index,
+        // position) is the road distance from the start of the bus traversal to the stop at that position of it.
+        template <typename BusDistance>
+        RaptorRouter(const std::deque<domain::Bus>& buses, const std::vector<std::string_view>& stop_names,
+                     BusDistance bus_distance, size_t max_transfers = UNLIMITED_TRANSFERS);
+
+        // Rides take time_per_distance per unit of the road distance. Rounds stop early once every target is reached
+        // and nothing can improve it; without targets the search covers all stops. With max_time no arrival later
+        // than it is kept.
+        SearchTree Search(StopIndex from, const std::vector<StopIndex>& targets, double wait_time,
+                          double time_per_distance, std::optional<double> max_time = std::nullopt) const;
+        std::optional<Journey> ExtractJourney(const SearchTree& tree, StopIndex to) const;
+        size_t GetStopCount() const;
+
+    private:
+        struct Pattern {
+            uint32_t bus_index;
+            // Position of the first stop of the pattern in the bus traversal.
+            uint32_t first_stop;
+            size_t stops_offset;
+            uint32_t stop_count;
+        };
+
+        static constexpr uint32_t NO_POSITION = std::numeric_limits<uint32_t>::max();
+
+        size_t stop_count_;
+        size_t max_rounds_;
+        std::vector<Pattern> patterns_;
+        std::vector<StopIndex> pattern_stops_;
+        // Road distances from the start of the bus traversal, one per pattern stop, so a ride is a subtraction.
+        std::vector<double> pattern_distances_;
+        // Every (pattern, position) a stop is called at, stop_patterns_offsets_[stop] is where the stop starts.
+        std::vector<size_t> stop_patterns_offsets_;
+        std::vector<std::pair<uint32_t, uint32_t>> stop_patterns_;
+
+        template <typename InputIterator, typename BusDistance>
+        void AddPattern(InputIterator first, InputIterator last, uint32_t bus_index, uint32_t first_stop,
+                        const std::unordered_map<std::string_view, StopIndex>& stop_indexes, BusDistance& bus_distance);
+        void CheckStop(StopIndex stop) const;
+    };
+
+    template <typename BusDistance>
+    RaptorRouter::RaptorRouter(const std::deque<domain::Bus>& buses, const std::vector<std::string_view>& stop_names,
+                               BusDistance bus_distance, size_t max_transfers)
+            : stop_count_(stop_names.size())
+            , max_rounds_(max_transfers == UNLIMITED_TRANSFERS ? UNLIMITED_TRANSFERS : max_transfers + 1)
+    {
+        std::unordered_map<std::string_view, StopIndex> stop_indexes;
+        for (StopIndex stop = 0; stop < stop_names.size(); ++stop) {
+            stop_indexes.emplace(stop_names[stop], stop);
+        }
+        uint32_t bus_index = 0;
+        for (const domain::Bus& bus : buses) {
+            if (bus.stops_.size() > 1) {
+                AddPattern(bus.stops_.begin(), bus.stops_.end(), bus_index, 0, stop_indexes, bus_distance);
+                if (bus.type_ == domain::BusType::REVERSE) {
+                    AddPattern(bus.stops_.crbegin(), bus.stops_.crend(), bus_index,
+                               static_cast<uint32_t>(bus.stops_.size() - 1), stop_indexes, bus_distance);
+                }
+            }
+            ++bus_index;
+        }
+
+        stop_patterns_offsets_.assign(stop_count_ + 1, 0);
+        for (StopIndex stop : pattern_stops_) {
+            ++stop_patterns_offsets_[stop + 1];
+        }
+        for (size_t stop = 0; stop < stop_count_; ++stop) {
+            stop_patterns_offsets_[stop + 1] += stop_patterns_offsets_[stop];
+        }
+        std::vector<size_t> next_slots(stop_patterns_offsets_.begin(), stop_patterns_offsets_.end() - 1);
+        stop_patterns_.resize(pattern_stops_.size());
+        for (uint32_t pattern = 0; pattern < patterns_.size(); ++pattern) {
+            for (uint32_t position = 0; position < patterns_[pattern].stop_count; ++position) {
+                const StopIndex stop = pattern_stops_[patterns_[pattern].stops_offset + position];
+                stop_patterns_[next_slots[stop]++] = {pattern, position};
+            }
+        }
+    }
+
+    template <typename InputIterator, typename BusDistance>
+    void RaptorRouter::AddPattern(InputIterator first, InputIterator last, uint32_t bus_index, uint32_t first_stop,
+                                  const std::unordered_map<std::string_view, StopIndex>& stop_indexes,
+                                  BusDistance& bus_distance) {
+        Pattern pattern{bus_index, first_stop, pattern_stops_.size(), 0};
+        for (; first != last; ++first, ++pattern.stop_count) {
+            auto stop = stop_indexes.find((*first)->name_);
+            if (stop == stop_indexes.end()) {
+                throw std::invalid_argument("Bus stop is missing from the stops of the router");
+            }
+            pattern_stops_.push_back(stop->second);
+            pattern_distances_.push_back(bus_distance(bus_index, first_stop + pattern.stop_count));
+        }
+        patterns_.push_back(pattern);
+    }
+
+    inline SearchTree RaptorRouter::Search(StopIndex from, const std::vector<StopIndex>& targets, double wait_time,
+                                           double time_per_distance, std::optional<double> max_time) const {
+        CheckStop(from);
+        for (StopIndex target : targets) {
+            CheckStop(target);
+        }
+        SearchTree tree{from, std::vector<double>(stop_count_, UNREACHABLE_TIME), {},
+                        std::vector<uint32_t>(stop_count_, SearchTree::NO_LABEL)};
+        tree.arrivals[from] = 0.0;
+
+        // A stop improved in the current round boards with its arrival from before the round.
+        std::vector<uint32_t> improved_rounds(stop_count_, 0);
+        std::vector<double> previous_arrivals(stop_count_, UNREACHABLE_TIME);
+        std::vector<StopIndex> marked_stops{from};
+        std::vector<StopIndex> improved_stops;
+        std::vector<uint32_t> first_positions(patterns_.size(), NO_POSITION);
+        std::vector<uint32_t> queued_patterns;
+        for (uint32_t round = 1; round <= max_rounds_ && !marked_stops.empty(); ++round) {
+            // A pattern is scanned from the earliest stop improved in the previous round, boarding earlier is no better.
+            queued_patterns.clear();
+            for (StopIndex stop : marked_stops) {
+                for (size_t i = stop_patterns_offsets_[stop]; i < stop_patterns_offsets_[stop + 1]; ++i) {
+                    const auto [pattern, position] = stop_patterns_[i];
+                    if (first_positions[pattern] == NO_POSITION) {
+                        queued_patterns.push_back(pattern);
+                    }
+                    first_positions[pattern] = std::min(first_positions[pattern], position);
+                }
+            }
+            improved_stops.clear();
+
+            // Once every target is reached, nothing arriving after the last of them can improve any.
+            double target_bound = targets.empty() ? UNREACHABLE_TIME : 0.0;
+            for (StopIndex target : targets) {
+                target_bound = std::max(target_bound, tree.arrivals[target]);
+            }
+
+            for (uint32_t pattern_index : queued_patterns) {
+                const Pattern& pattern = patterns_[pattern_index];
+                const StopIndex* stops = &pattern_stops_[pattern.stops_offset];
+                const double* distances = &pattern_distances_[pattern.stops_offset];
+                uint32_t board_position = NO_POSITION;
+                double departure = UNREACHABLE_TIME;
+                for (uint32_t position = first_positions[pattern_index]; position < pattern.stop_count; ++position) {
+                    const StopIndex stop = stops[position];
+                    double arrival = UNREACHABLE_TIME;
+                    if (board_position != NO_POSITION) {
+                        arrival = departure + (distances[position] - distances[board_position]) * time_per_distance;
+                        const bool is_pruned = arrival >= target_bound || (max_time && arrival > *max_time);
+                        if (arrival < tree.arrivals[stop] && !is_pruned) {
+                            if (improved_rounds[stop] == round) {
+                                Label& label = tree.labels[tree.last_labels[stop]];
+                                label = {pattern_index, board_position, position, round, label.previous};
+                            } else {
+                                improved_rounds[stop] = round;
+                                previous_arrivals[stop] = tree.arrivals[stop];
+                                improved_stops.push_back(stop);
+                                tree.labels.push_back({pattern_index, board_position, position, round, tree.last_labels[stop]});
+                                tree.last_labels[stop] = static_cast<uint32_t>(tree.labels.size() - 1);
+                            }
+                            tree.arrivals[stop] = arrival;
+                        }
+                    }
+                    // Boarding here beats the current ride if waiting here departs before the ride gets here.
+                    const double previous_arrival = improved_rounds[stop] == round ? previous_arrivals[stop] : tree.arrivals[stop];
+                    if (previous_arrival != UNREACHABLE_TIME && previous_arrival + wait_time < arrival) {
+                        board_position = position;
+                        departure = previous_arrival + wait_time;
+                    }
+                }
+                first_positions[pattern_index] = NO_POSITION;
+            }
+            std::swap(marked_stops, improved_stops);
+        }
+        return tree;
+    }
+
+    inline std::optional<Journey> RaptorRouter::ExtractJourney(const SearchTree& tree, StopIndex to) const {
+        CheckStop(to);
+        if (tree.arrivals[to] == UNREACHABLE_TIME) {
+            return std::nullopt;
+        }
+        Journey journey{tree.arrivals[to], {}};
+        StopIndex stop = to;
+        uint32_t round = std::numeric_limits<uint32_t>::max();
+        while (stop != tree.from) {
+            uint32_t label_index = tree.last_labels[stop];
+            while (tree.labels[label_index].round > round) {
+                label_index = tree.labels[label_index].previous;
+            }
+            const Label& label = tree.labels[label_index];
+            const Pattern& pattern = patterns_[label.pattern];
+            const StopIndex board_stop = pattern_stops_[pattern.stops_offset + label.board_position];
+            journey.legs.push_back({pattern.bus_index, pattern.first_stop + label.board_position,
+                                    label.alight_position - label.board_position, board_stop});
+            stop = board_stop;
+            round = label.round - 1;
+        }
+        std::reverse(journey.legs.begin(), journey.legs.end());
+        return journey;
+    }
+
+    inline size_t RaptorRouter::GetStopCount() const {
+        return stop_count_;
+    }
+
+    inline void RaptorRouter::CheckStop(StopIndex stop) const {
+        if (stop >= stop_count_) {
+            throw std::out_of_range("Stop index is out of range");
+        }
+    }
+}  // namespace raptor
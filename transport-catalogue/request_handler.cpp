@@ -2,35 +2,75 @@
 #include "json_builder.h"
 
 RequestHandler::OptionalBusInfo RequestHandler::GetBusStat(std::string_view bus_name) const {
-    return transport_catalogue_.GetBusInfo(std::string (bus_name));
+    return transport_catalogue_.GetBusInfo(bus_name);
 }
 
 RequestHandler::OptionalStopInfo RequestHandler::GetBusesByStop(std::string_view stop_name) const {
-    return transport_catalogue_.GetStopInfo(std::string (stop_name));
+    return transport_catalogue_.GetStopInfo(stop_name);
 }
 
 void RequestHandler::Render(std::ostream& out) const {
     renderer_.Render(out);
 }
 
-std::optional<transport_router::EdgeDescriptions> RequestHandler::BuildOptimalRoute(std::string_view stop_from, std::string_view stop_to) const {
+transport_router::RouteDescription RequestHandler::BuildOptimalRoute(std::string_view stop_from, std::string_view stop_to) const {
     return router_.BuildRoute(stop_from, stop_to);
 }
 
+std::vector<transport_router::RouteDescription> RequestHandler::BuildOptimalRoutes(std::string_view stop_from,
+                                                                                   const std::vector<std::string_view>& stops_to) const {
+    return router_.BuildRoutes(stop_from, stops_to);
+}
+
+std::vector<transport_router::RouteDescription> RequestHandler::BuildOptimalRoutes(std::string_view stop_from,
+                                                                                   const std::vector<std::string_view>& stops_to,
+                                                                                   const transport_router::RouteMetric& metric) const {
+    return router_.BuildRoutes(stop_from, stops_to, metric);
+}
+
+transport_router::RouteMetric RequestHandler::GetRouteMetric() const {
+    return router_.GetRouteMetric();
+}
+
+transport_router::TimeMatrix RequestHandler::BuildTimeMatrix(const std::vector<std::string_view>& stops_from,
+                                                             const std::vector<std::string_view>& stops_to) const {
+    return router_.BuildTimeMatrix(stops_from, stops_to);
+}
+
+std::optional<transport_router::Isochrone> RequestHandler::BuildIsochrone(std::string_view stop_from, double max_time) const {
+    return router_.BuildIsochrone(stop_from, max_time);
+}
+
+std::vector<domain::NearbyStop> RequestHandler::FindNearbyStops(geo::Coordinates point, std::optional<double> radius,
+                                                                std::optional<size_t> count) const {
+    const double max_radius = radius.value_or(std::numeric_limits<double>::infinity());
+    if (count.has_value()) {
+        return transport_catalogue_.FindNearestStops(point, *count, max_radius);
+    }
+    return transport_catalogue_.FindStopsWithinRadius(point, max_radius);
+}
+
+cache::CacheStatistics RequestHandler::GetRouteCacheStatistics() const {
+    return router_.GetRouteCacheStatistics();
+}
+
+std::optional<graph::SearchStatistics> RequestHandler::GetSearchStatistics() const {
+    return router_.GetSearchStatistics();
+}
+
 json::Array MakeBusesArray(domain::StopInfo& stop_info) {
-    if (stop_info.buses_ == nullptr) return {};
     json::Array buses;
-    buses.reserve(stop_info.buses_->size());
-    for (auto bus : *stop_info.buses_) {
+    buses.reserve(stop_info.buses_.size());
+    for (auto bus : stop_info.buses_) {
         buses.emplace_back(std::string(bus));
     }
     return buses;
 }
 
-json::Node MakeErrorResponse(const json::Dict* query) {
+json::Node MakeErrorResponse(const json::Dict* query, const std::string& error_message) {
     return json::Builder{}.StartDict()
                               .Key("request_id").Value(query->at("id").GetValue())
-                              .Key("error_message").Value("not found")
+                              .Key("error_message").Value(error_message)
                           .EndDict()
                       .Build();
 }
@@ -66,7 +106,8 @@ json::Node MakeJSONMapResponse(const std::string& str, const json::Dict* query)
 json::Node MakeJSONRouteResponse(const transport_router::EdgeDescriptions& route_description, const json::Dict* query) {
     json::Array items;
     double total_time = 0.0;
-    for (auto description : route_description) {
+    const bool with_alternative_buses = query->count("with_alternative_buses") > 0 && query->at("with_alternative_buses").AsBool();
+    for (const auto& description : route_description) {
         total_time += description.time_;
         if (description.type_ == transport_router::EdgeType::WAIT) {
             json::Node dict = json::Builder{}.StartDict()
@@ -84,6 +125,15 @@ json::Node MakeJSONRouteResponse(const transport_router::EdgeDescriptions& route
                                                  .Key("time").Value(description.time_)
                                              .EndDict()
                                          .Build();
+            if (with_alternative_buses) {
+                json::Array alternative_buses;
+                if (description.alternative_buses_ != nullptr) {
+                    for (std::string_view bus : *description.alternative_buses_) {
+                        alternative_buses.emplace_back(std::string(bus));
+                    }
+                }
+                dict.AsDict().emplace("alternative_buses", std::move(alternative_buses));
+            }
             items.push_back(dict);
         }
     }
@@ -93,4 +143,84 @@ json::Node MakeJSONRouteResponse(const transport_router::EdgeDescriptions& route
                                 .Key("items").Value(items)
                           .EndDict()
                       .Build();
-}
\ No newline at end of file
+}
+
+json::Node MakeJSONMatrixResponse(const transport_router::TimeMatrix& time_matrix, const json::Dict* query) {
+    json::Array rows;
+    rows.reserve(time_matrix.size());
+    for (const auto& times : time_matrix) {
+        json::Array row;
+        row.reserve(times.size());
+        for (const auto& time : times) {
+            row.push_back(time.has_value() ? json::Node(*time) : json::Node(nullptr));
+        }
+        rows.push_back(std::move(row));
+    }
+    return json::Builder{}.StartDict()
+                                .Key("request_id").Value(query->at("id").GetValue())
+                                .Key("total_times").Value(rows)
+                          .EndDict()
+                      .Build();
+}
+
+json::Node MakeJSONIsochroneResponse(const transport_router::Isochrone& isochrone, const json::Dict* query) {
+    json::Array stops;
+    stops.reserve(isochrone.size());
+    for (const auto& reachable_stop : isochrone) {
+        stops.push_back(json::Builder{}.StartDict()
+                                           .Key("stop_name").Value(std::string(reachable_stop.stop_name_))
+                                           .Key("time").Value(reachable_stop.time_)
+                                       .EndDict()
+                                   .Build());
+    }
+    return json::Builder{}.StartDict()
+                                .Key("request_id").Value(query->at("id").GetValue())
+                                .Key("stops").Value(stops)
+                          .EndDict()
+                      .Build();
+}
+
+json::Node MakeJSONNearbyStopsResponse(const std::vector<domain::NearbyStop>& nearby_stops, const json::Dict* query) {
+    json::Array stops;
+    stops.reserve(nearby_stops.size());
+    for (const auto& nearby_stop : nearby_stops) {
+        stops.push_back(json::Builder{}.StartDict()
+                                           .Key("stop_name").Value(std::string(nearby_stop.name_))
+                                           .Key("distance").Value(nearby_stop.distance_)
+                                       .EndDict()
+                                   .Build());
+    }
+    return json::Builder{}.StartDict()
+                                .Key("request_id").Value(query->at("id").GetValue())
+                                .Key("stops").Value(stops)
+                          .EndDict()
+                      .Build();
+}
+
+json::Node MakeJSONRoutingStatisticsResponse(const cache::CacheStatistics& cache_statistics,
+                                             const std::optional<graph::SearchStatistics>& search_statistics,
+                                             const json::Dict* query) {
+    json::Node route_cache = json::Builder{}.StartDict()
+                                                .Key("hits").Value(static_cast<int>(cache_statistics.hits_))
+                                                .Key("misses").Value(static_cast<int>(cache_statistics.misses_))
+                                                .Key("size").Value(static_cast<int>(cache_statistics.size_))
+                                            .EndDict()
+                                        .Build();
+    json::Node search = nullptr;
+    if (search_statistics.has_value()) {
+        const double mean_settled_vertices = search_statistics->queries == 0 ? 0.0 :
+                static_cast<double>(search_statistics->settled_vertices) / static_cast<double>(search_statistics->queries);
+        search = json::Builder{}.StartDict()
+                                    .Key("queries").Value(static_cast<int>(search_statistics->queries))
+                                    .Key("mean_settled_vertices").Value(mean_settled_vertices)
+                                    .Key("max_settled_vertices").Value(static_cast<int>(search_statistics->max_settled_vertices))
+                                .EndDict()
+                            .Build();
+    }
+    return json::Builder{}.StartDict()
+                                .Key("request_id").Value(query->at("id").GetValue())
+                                .Key("route_cache").Value(route_cache.GetValue())
+                                .Key("search").Value(search.GetValue())
+                          .EndDict()
+                      .Build();
+}
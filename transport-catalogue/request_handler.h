@@ -10,30 +10,49 @@ public:
     using OptionalBusInfo = const std::optional<domain::BusInfo>;
     using OptionalStopInfo = const std::optional<domain::StopInfo>;
 
-    RequestHandler(const transport_catalogue::TransportCatalogue& transport_catalogue,
+    RequestHandler(const transport_catalogue::FrozenTransportCatalogue& transport_catalogue,
                    renderer::RenderSettings& render_settings,
                    const transport_router::TransportRouter& router)
                    : transport_catalogue_(transport_catalogue),
-                     renderer_(render_settings, std::move(transport_catalogue.GetValidCoordinates()),
-                             transport_catalogue.GetSortedBuses(),
-                             transport_catalogue.GetSortedStops()),
+                     renderer_(render_settings, std::move(transport_catalogue.GetTransportCatalogue().GetValidCoordinates()),
+                             transport_catalogue.GetTransportCatalogue().GetSortedBuses(),
+                             transport_catalogue.GetTransportCatalogue().GetSortedStops()),
                      router_(router) {
     }
 
     [[nodiscard]] OptionalBusInfo GetBusStat(std::string_view bus_name) const;
     [[nodiscard]] OptionalStopInfo GetBusesByStop(std::string_view stop_name) const;
     void Render(std::ostream& out) const;
-    std::optional<transport_router::EdgeDescriptions> BuildOptimalRoute(std::string_view stop_from, std::string_view stop_to) const;
+    transport_router::RouteDescription BuildOptimalRoute(std::string_view stop_from, std::string_view stop_to) const;
+    std::vector<transport_router::RouteDescription> BuildOptimalRoutes(std::string_view stop_from,
+                                                                       const std::vector<std::string_view>& stops_to) const;
+    std::vector<transport_router::RouteDescription> BuildOptimalRoutes(std::string_view stop_from,
+                                                                       const std::vector<std::string_view>& stops_to,
+                                                                       const transport_router::RouteMetric& metric) const;
+    transport_router::RouteMetric GetRouteMetric() const;
+    transport_router::TimeMatrix BuildTimeMatrix(const std::vector<std::string_view>& stops_from,
+                                                 const std::vector<std::string_view>& stops_to) const;
+    std::optional<transport_router::Isochrone> BuildIsochrone(std::string_view stop_from, double max_time) const;
+    std::vector<domain::NearbyStop> FindNearbyStops(geo::Coordinates point, std::optional<double> radius,
+                                                    std::optional<size_t> count) const;
+    cache::CacheStatistics GetRouteCacheStatistics() const;
+    std::optional<graph::SearchStatistics> GetSearchStatistics() const;
 
 private:
-    const transport_catalogue::TransportCatalogue& transport_catalogue_;
+    const transport_catalogue::FrozenTransportCatalogue& transport_catalogue_;
     renderer::MapRenderer renderer_;
     const transport_router::TransportRouter& router_;
 };
 
 json::Array MakeBusesArray(domain::StopInfo& stop_info);
-json::Node MakeErrorResponse(const json::Dict* query);
+json::Node MakeErrorResponse(const json::Dict* query, const std::string& error_message = "not found");
 json::Node MakeJSONStopResponse(domain::StopInfo& stop_info, const json::Dict* query);
 json::Node MakeJSONBusResponse(domain::BusInfo& bus_info, const json::Dict* query);
 json::Node MakeJSONMapResponse(const std::string& str, const json::Dict* query);
-json::Node MakeJSONRouteResponse(const transport_router::EdgeDescriptions& route_description, const json::Dict* query);
\ No newline at end of file
+json::Node MakeJSONRouteResponse(const transport_router::EdgeDescriptions& route_description, const json::Dict* query);
+json::Node MakeJSONMatrixResponse(const transport_router::TimeMatrix& time_matrix, const json::Dict* query);
+json::Node MakeJSONIsochroneResponse(const transport_router::Isochrone& isochrone, const json::Dict* query);
+json::Node MakeJSONNearbyStopsResponse(const std::vector<domain::NearbyStop>& nearby_stops, const json::Dict* query);
+json::Node MakeJSONRoutingStatisticsResponse(const cache::CacheStatistics& cache_statistics,
+                                             const std::optional<graph::SearchStatistics>& search_statistics,
+                                             const json::Dict* query);
\ No newline at end of file
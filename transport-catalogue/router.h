@@ -1,156 +1,388 @@
 #pragma once
 
+#include "dijkstra_router.h"
 #include "graph.h"
 #include "graph.pb.h"
+#include "min_plus.h"
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <condition_variable>
 #include <cstdint>
 #include <iterator>
+#include <limits>
+#include <mutex>
 #include <optional>
 #include <stdexcept>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace graph {
 
+    // How the all-pairs matrix keeps route weights. By default it stores the graph's own weight type.
+    template <typename Weight, typename MatrixWeight>
+    struct MatrixWeightTraits {
+        static constexpr MatrixWeight UNREACHABLE = std::numeric_limits<MatrixWeight>::has_infinity ?
+                                                    std::numeric_limits<MatrixWeight>::infinity() :
+                                                    std::numeric_limits<MatrixWeight>::max();
+
+        static MatrixWeight FromWeight(Weight weight) {
+            return static_cast<MatrixWeight>(weight);
+        }
+        static Weight ToWeight(MatrixWeight weight) {
+            return static_cast<Weight>(weight);
+        }
+    };
+
+    // Fixed point in hundredths of a weight unit. UNREACHABLE is half of the range, so the sum of two
+    // stored weights never wraps around and a sum through an unreachable cell never beats a real route.
     template <typename Weight>
+    struct MatrixWeightTraits<Weight, uint32_t> {
+        static constexpr uint32_t SCALE = 100;
+        static constexpr uint32_t UNREACHABLE = std::numeric_limits<int32_t>::max();
+
+        static uint32_t FromWeight(Weight weight) {
+            const long long scaled_weight = std::llround(weight * SCALE);
+            if (scaled_weight >= UNREACHABLE) {
+                throw std::overflow_error("Edge weight doesn't fit the fixed-point matrix");
+            }
+            return static_cast<uint32_t>(scaled_weight);
+        }
+        static Weight ToWeight(uint32_t weight) {
+            return static_cast<Weight>(weight) / SCALE;
+        }
+    };
+
+    template <typename Weight, typename MatrixWeight = Weight>
     class Router {
     private:
         using Graph = DirectedWeightedGraph<Weight>;
+        using Traits = MatrixWeightTraits<Weight, MatrixWeight>;
 
     public:
-        struct RouteInternalData {
-            Weight weight;
-            std::optional<EdgeId> prev_edge;
+        // Row-major vertex_count x vertex_count matrices. Unreachable cells hold UNREACHABLE_WEIGHT,
+        // cells without a previous edge (the route start itself) hold NO_EDGE.
+        struct RoutesInternalData {
+            std::vector<MatrixWeight> weights;
+            std::vector<uint32_t> prev_edges;
         };
-        using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
 
-        explicit Router(const Graph& graph);
+        static constexpr MatrixWeight UNREACHABLE_WEIGHT = Traits::UNREACHABLE;
+        static constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+        explicit Router(const Graph& graph, size_t thread_count = 1);
         Router(const Graph& graph, RoutesInternalData&& routes_internal_data);
 
-        struct RouteInfo {
-            Weight weight;
-            std::vector<EdgeId> edges;
-        };
+        using RouteInfo = graph::RouteInfo<Weight>;
 
         std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+        std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const;
+        // Row-major sources x targets matrix of route weights, without reconstructing the routes themselves.
+        std::vector<std::optional<Weight>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+                                                             const std::vector<VertexId>& targets) const;
         transport_catalogue_serialize::Router GetSerializedRouter() const;
+        // Repairs the matrix after the graph was refilled in place over the same vertices. new_edge_ids maps every
+        // old edge id to its new one (nullopt if removed), raised_edges are old ids of slower or removed edges and
+        // lowered_edges are new ids of faster or added ones. Only rows whose shortest-path tree used a raised edge
+        // or can be shortened by a lowered one are searched again, each by one Dijkstra search. Returns their number.
+        size_t Update(const std::vector<std::optional<EdgeId>>& new_edge_ids,
+                      const std::vector<EdgeId>& raised_edges, const std::vector<EdgeId>& lowered_edges,
+                      size_t thread_count = 1);
 
     private:
+        // Lets the precompute threads finish relaxing through one vertex before any of them moves to the next.
+        class Barrier {
+        public:
+            explicit Barrier(size_t thread_count) : thread_count_(thread_count) {}
+
+            void ArriveAndWait() {
+                std::unique_lock lock(mutex_);
+                const size_t generation = generation_;
+                if (++arrived_count_ == thread_count_) {
+                    arrived_count_ = 0;
+                    ++generation_;
+                    condition_.notify_all();
+                } else {
+                    condition_.wait(lock, [this, generation] { return generation != generation_; });
+                }
+            }
+
+        private:
+            std::mutex mutex_;
+            std::condition_variable condition_;
+            size_t thread_count_;
+            size_t arrived_count_ = 0;
+            size_t generation_ = 0;
+        };
 
         void InitializeRoutesInternalData(const Graph& graph) {
             const size_t vertex_count = graph.GetVertexCount();
+            if (graph.GetEdgeCount() >= NO_EDGE) {
+                throw std::length_error("Too many edges for the all-pairs router");
+            }
             for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-                routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+                routes_internal_data_.weights[vertex * vertex_count + vertex] = ZERO_MATRIX_WEIGHT;
                 for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
                     const auto& edge = graph.GetEdge(edge_id);
                     if (edge.weight < ZERO_WEIGHT) {
                         throw std::domain_error("Edges' weights should be non-negative");
                     }
-                    auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                    if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                        route_internal_data = RouteInternalData{edge.weight, edge_id};
+                    const size_t cell = vertex * vertex_count + edge.to;
+                    const MatrixWeight weight = Traits::FromWeight(edge.weight);
+                    if (weight < routes_internal_data_.weights[cell]) {
+                        routes_internal_data_.weights[cell] = weight;
+                        routes_internal_data_.prev_edges[cell] = static_cast<uint32_t>(edge_id);
                     }
                 }
             }
         }
 
-        void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-                        const RouteInternalData& route_to) {
-            auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-            const Weight candidate_weight = route_from.weight + route_to.weight;
-            if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-                route_relaxing = {candidate_weight,
-                                  route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
-            }
-        }
-
-        void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-            for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-                if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
+        void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through,
+                                                  VertexId rows_begin, VertexId rows_end) {
+            const MatrixWeight* weights_through = &routes_internal_data_.weights[vertex_through * vertex_count];
+            const uint32_t* prev_edges_through = &routes_internal_data_.prev_edges[vertex_through * vertex_count];
+            for (VertexId vertex_from = rows_begin; vertex_from < rows_end; ++vertex_from) {
+                MatrixWeight* weights_from = &routes_internal_data_.weights[vertex_from * vertex_count];
+                uint32_t* prev_edges_from = &routes_internal_data_.prev_edges[vertex_from * vertex_count];
+                const MatrixWeight weight_from = weights_from[vertex_through];
+                if (weight_from == UNREACHABLE_WEIGHT || vertex_from == vertex_through) {
+                    continue;
+                }
+                const uint32_t prev_edge_from = prev_edges_from[vertex_through];
+                if constexpr (std::is_same_v<MatrixWeight, float> || std::is_same_v<MatrixWeight, uint32_t>) {
+                    min_plus::RelaxRow(weights_through, prev_edges_through, weights_from, prev_edges_from,
+                                       vertex_count, weight_from, prev_edge_from, NO_EDGE);
+                } else {
                     for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                        if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                            RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
+                        if (weights_through[vertex_to] == UNREACHABLE_WEIGHT) {
+                            continue;
+                        }
+                        const MatrixWeight candidate_weight = weight_from + weights_through[vertex_to];
+                        if (candidate_weight < weights_from[vertex_to]) {
+                            weights_from[vertex_to] = candidate_weight;
+                            prev_edges_from[vertex_to] = prev_edges_through[vertex_to] != NO_EDGE ?
+                                                         prev_edges_through[vertex_to] : prev_edge_from;
                         }
                     }
                 }
             }
         }
 
+        // Relaxing through a vertex never changes its own row or column, so within one iteration
+        // the rows are independent and the result matches the sequential order bit for bit.
+        void RelaxRoutesInternalDataInParallel(size_t vertex_count, size_t thread_count) {
+            Barrier barrier(thread_count);
+            const size_t rows_per_thread = (vertex_count + thread_count - 1) / thread_count;
+            std::vector<std::thread> threads;
+            threads.reserve(thread_count);
+            for (size_t thread_index = 0; thread_index < thread_count; ++thread_index) {
+                const VertexId rows_begin = std::min(vertex_count, thread_index * rows_per_thread);
+                const VertexId rows_end = std::min(vertex_count, rows_begin + rows_per_thread);
+                threads.emplace_back([this, &barrier, vertex_count, rows_begin, rows_end] {
+                    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
+                        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through, rows_begin, rows_end);
+                        barrier.ArriveAndWait();
+                    }
+                });
+            }
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+        }
+
         static constexpr Weight ZERO_WEIGHT{};
+        static constexpr MatrixWeight ZERO_MATRIX_WEIGHT{};
         const Graph& graph_;
+        size_t vertex_count_;
         RoutesInternalData routes_internal_data_;
     };
 
-    template <typename Weight>
-    Router<Weight>::Router(const Graph& graph)
+    template <typename Weight, typename MatrixWeight>
+    Router<Weight, MatrixWeight>::Router(const Graph& graph, size_t thread_count)
             : graph_(graph)
-            , routes_internal_data_(graph.GetVertexCount(),
-                                    std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+            , vertex_count_(graph.GetVertexCount())
+            , routes_internal_data_{std::vector<MatrixWeight>(vertex_count_ * vertex_count_, UNREACHABLE_WEIGHT),
+                                    std::vector<uint32_t>(vertex_count_ * vertex_count_, NO_EDGE)}
     {
         InitializeRoutesInternalData(graph);
 
         const size_t vertex_count = graph.GetVertexCount();
+        if (thread_count == 0) {
+            thread_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        }
+        thread_count = std::min(thread_count, vertex_count);
+        if (thread_count > 1) {
+            RelaxRoutesInternalDataInParallel(vertex_count, thread_count);
+            return;
+        }
         for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-            RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+            RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through, 0, vertex_count);
         }
     }
 
-    template<typename Weight>
-    Router<Weight>::Router(const Router::Graph& graph, Router::RoutesInternalData&& routes_internal_data)
-            : graph_(graph), routes_internal_data_(routes_internal_data) {
+    template <typename Weight, typename MatrixWeight>
+    Router<Weight, MatrixWeight>::Router(const Router::Graph& graph, Router::RoutesInternalData&& routes_internal_data)
+            : graph_(graph), vertex_count_(graph.GetVertexCount()), routes_internal_data_(std::move(routes_internal_data)) {
+        if (routes_internal_data_.weights.size() != vertex_count_ * vertex_count_
+            || routes_internal_data_.prev_edges.size() != vertex_count_ * vertex_count_) {
+            throw std::invalid_argument("Routes internal data doesn't match the graph");
+        }
     }
 
-    template <typename Weight>
-    std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
-                                                                                 VertexId to) const {
-        const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-        if (!route_internal_data) {
+    template <typename Weight, typename MatrixWeight>
+    std::vector<std::optional<typename Router<Weight, MatrixWeight>::RouteInfo>>
+    Router<Weight, MatrixWeight>::BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const {
+        std::vector<std::optional<RouteInfo>> routes;
+        routes.reserve(targets.size());
+        for (const VertexId to : targets) {
+            routes.push_back(BuildRoute(from, to));
+        }
+        return routes;
+    }
+
+    template <typename Weight, typename MatrixWeight>
+    std::vector<std::optional<Weight>> Router<Weight, MatrixWeight>::BuildWeightMatrix(const std::vector<VertexId>& sources,
+                                                                                       const std::vector<VertexId>& targets) const {
+        std::vector<std::optional<Weight>> weights;
+        weights.reserve(sources.size() * targets.size());
+        for (const VertexId from : sources) {
+            for (const VertexId to : targets) {
+                if (from >= vertex_count_ || to >= vertex_count_) {
+                    throw std::out_of_range("Vertex id is out of range");
+                }
+                const MatrixWeight weight = routes_internal_data_.weights[from * vertex_count_ + to];
+                weights.push_back(weight == UNREACHABLE_WEIGHT ? std::nullopt : std::optional<Weight>(Traits::ToWeight(weight)));
+            }
+        }
+        return weights;
+    }
+
+    template <typename Weight, typename MatrixWeight>
+    std::optional<typename Router<Weight, MatrixWeight>::RouteInfo>
+    Router<Weight, MatrixWeight>::BuildRoute(VertexId from, VertexId to) const {
+        if (from >= vertex_count_ || to >= vertex_count_) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        const size_t row = from * vertex_count_;
+        const MatrixWeight weight = routes_internal_data_.weights[row + to];
+        if (weight == UNREACHABLE_WEIGHT) {
             return std::nullopt;
         }
-        const Weight weight = route_internal_data->weight;
         std::vector<EdgeId> edges;
-        for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-             edge_id;
-             edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+        for (uint32_t edge_id = routes_internal_data_.prev_edges[row + to];
+             edge_id != NO_EDGE;
+             edge_id = routes_internal_data_.prev_edges[row + graph_.GetEdge(edge_id).from])
         {
-            edges.push_back(*edge_id);
+            edges.push_back(edge_id);
         }
         std::reverse(edges.begin(), edges.end());
 
-        return RouteInfo{weight, std::move(edges)};
+        return RouteInfo{Traits::ToWeight(weight), std::move(edges)};
     }
 
-    template<typename Weight>
-    transport_catalogue_serialize::Router Router<Weight>::GetSerializedRouter() const {
-        transport_catalogue_serialize::Router router_serialized;
+    template <typename Weight, typename MatrixWeight>
+    size_t Router<Weight, MatrixWeight>::Update(const std::vector<std::optional<EdgeId>>& new_edge_ids,
+                                                const std::vector<EdgeId>& raised_edges,
+                                                const std::vector<EdgeId>& lowered_edges,
+                                                size_t thread_count) {
+        if (graph_.GetVertexCount() != vertex_count_) {
+            throw std::invalid_argument("Updated graph has another number of vertices");
+        }
+        if (graph_.GetEdgeCount() >= NO_EDGE) {
+            throw std::length_error("Too many edges for the all-pairs router");
+        }
+        std::vector<bool> is_raised(new_edge_ids.size(), false);
+        for (const EdgeId edge_id : raised_edges) {
+            is_raised[edge_id] = true;
+        }
 
-        for (auto& arr : routes_internal_data_) {
-            transport_catalogue_serialize::RoutesInternalDataArray routes_internal_data_array_serialized;
-            for (auto& route_internal_data : arr) {
-                transport_catalogue_serialize::RouteInternalData route_internal_data_serialized;
-                if (route_internal_data.has_value()) {
-                    route_internal_data_serialized.set_weight(route_internal_data.value().weight);
-                    if (route_internal_data.value().prev_edge.has_value()) {
-                        transport_catalogue_serialize::PrevEdge prev_edge_serialized;
-                        prev_edge_serialized.set_has_value(true);
-                        prev_edge_serialized.set_prev_edge(route_internal_data.value().prev_edge.value());
-                        *route_internal_data_serialized.mutable_prev_edge() = std::move(prev_edge_serialized);
-                    } else {
-                        transport_catalogue_serialize::PrevEdge prev_edge_serialized;
-                        prev_edge_serialized.set_has_value(false);
-                        *route_internal_data_serialized.mutable_prev_edge() = std::move(prev_edge_serialized);
-                    }
-                    route_internal_data_serialized.set_has_value(true);
-                } else {
-                    route_internal_data_serialized.set_has_value(false);
+        std::vector<bool> is_stale(vertex_count_, false);
+        for (VertexId from = 0; from < vertex_count_; ++from) {
+            uint32_t* prev_edges = &routes_internal_data_.prev_edges[from * vertex_count_];
+            for (VertexId to = 0; to < vertex_count_; ++to) {
+                if (prev_edges[to] == NO_EDGE) continue;
+                if (is_raised[prev_edges[to]]) {
+                    is_stale[from] = true;
+                    break;
                 }
-                *routes_internal_data_array_serialized.add_routes_internal_data() = std::move(route_internal_data_serialized);
+                prev_edges[to] = static_cast<uint32_t>(*new_edge_ids[prev_edges[to]]);
             }
-            *router_serialized.add_array_of_routes_internal_data() = std::move(routes_internal_data_array_serialized);
         }
+
+        for (VertexId from = 0; from < vertex_count_; ++from) {
+            if (is_stale[from]) continue;
+            const MatrixWeight* weights = &routes_internal_data_.weights[from * vertex_count_];
+            is_stale[from] = std::any_of(lowered_edges.begin(), lowered_edges.end(), [this, weights](EdgeId edge_id) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                if (weights[edge.from] == UNREACHABLE_WEIGHT) return false;
+                return weights[edge.to] == UNREACHABLE_WEIGHT ||
+                       weights[edge.from] + Traits::FromWeight(edge.weight) < weights[edge.to];
+            });
+        }
+
+        std::vector<VertexId> stale_rows;
+        for (VertexId from = 0; from < vertex_count_; ++from) {
+            if (is_stale[from]) {
+                stale_rows.push_back(from);
+            }
+        }
+        // A compact matrix adds up edge weights already converted to it, so the searches do the same.
+        Graph converted_graph;
+        if constexpr (!std::is_same_v<MatrixWeight, Weight>) {
+            std::vector<Weight> converted_weights;
+            converted_weights.reserve(graph_.GetEdgeCount());
+            for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+                converted_weights.push_back(Traits::ToWeight(Traits::FromWeight(graph_.GetEdge(edge_id).weight)));
+            }
+            converted_graph = graph_.WithWeights(converted_weights);
+        }
+        const Graph& search_graph = std::is_same_v<MatrixWeight, Weight> ? graph_ : converted_graph;
+        // Every search writes its own row only, so the rows are split between the threads.
+        auto search_rows = [this, &stale_rows, &search_graph](size_t rows_begin, size_t rows_end) {
+            for (size_t row = rows_begin; row < rows_end; ++row) {
+                const VertexId from = stale_rows[row];
+                const ShortestPathTree<Weight> tree = BuildShortestPathTree(search_graph, from, {});
+                MatrixWeight* weights = &routes_internal_data_.weights[from * vertex_count_];
+                uint32_t* prev_edges = &routes_internal_data_.prev_edges[from * vertex_count_];
+                for (VertexId to = 0; to < vertex_count_; ++to) {
+                    weights[to] = tree.weights[to] ? Traits::FromWeight(*tree.weights[to]) : UNREACHABLE_WEIGHT;
+                    prev_edges[to] = tree.prev_edges[to] ? static_cast<uint32_t>(*tree.prev_edges[to]) : NO_EDGE;
+                }
+            }
+        };
+        if (thread_count == 0) {
+            thread_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        }
+        thread_count = std::max<size_t>(std::min(thread_count, stale_rows.size()), 1);
+        const size_t rows_per_thread = (stale_rows.size() + thread_count - 1) / thread_count;
+        std::vector<std::thread> threads;
+        for (size_t thread_index = 1; thread_index < thread_count; ++thread_index) {
+            const size_t rows_begin = std::min(stale_rows.size(), thread_index * rows_per_thread);
+            threads.emplace_back(search_rows, rows_begin, std::min(stale_rows.size(), rows_begin + rows_per_thread));
+        }
+        search_rows(0, std::min(stale_rows.size(), rows_per_thread));
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        return stale_rows.size();
+    }
+
+    template <typename Weight, typename MatrixWeight>
+    transport_catalogue_serialize::Router Router<Weight, MatrixWeight>::GetSerializedRouter() const {
+        transport_catalogue_serialize::Router router_serialized;
+        const auto& weights = routes_internal_data_.weights;
+        if constexpr (std::is_same_v<MatrixWeight, float>) {
+            router_serialized.mutable_float_weights()->Add(weights.begin(), weights.end());
+        } else if constexpr (std::is_same_v<MatrixWeight, uint32_t>) {
+            router_serialized.mutable_fixed_point_weights()->Add(weights.begin(), weights.end());
+        } else {
+            router_serialized.mutable_weights()->Add(weights.begin(), weights.end());
+        }
+        router_serialized.mutable_prev_edges()->Add(routes_internal_data_.prev_edges.begin(), routes_internal_data_.prev_edges.end());
         return router_serialized;
     }
 }  // namespace graph
\ No newline at end of file
@@ -6,37 +6,86 @@ namespace serialization {
     using PairsOfVerticesMap = std::unordered_map<std::string_view, std::pair<VertexId, VertexId>>;
 
     transport_catalogue_serialize::TransportCatalogue SerializeTransportCatalogue(const transport_catalogue::TransportCatalogue& transport_catalogue);
+    transport_catalogue_serialize::NameIndex SerializeNameIndex(const perfect_hash::NameIndex& name_index);
+    transport_catalogue_serialize::StopGrid SerializeStopGrid(const spatial::GridIndex& stop_grid);
     transport_catalogue_serialize::RenderSettings SerializeRenderSettings(const renderer::RenderSettings& render_settings);
     transport_catalogue_serialize::TransportRouter SerializeTransportRouter(const transport_router::TransportRouter& transport_router);
 
     transport_catalogue::TransportCatalogue DeserializeTransportCatalogue(const transport_catalogue_serialize::TransportCatalogue& transport_catalogue_serialized);
+    transport_catalogue::FrozenTransportCatalogue DeserializeFrozenTransportCatalogue(
+            const transport_catalogue_serialize::TransportCatalogue& transport_catalogue_serialized,
+            const transport_catalogue::TransportCatalogue& transport_catalogue
+            );
+    template <typename Item>
+    perfect_hash::NameIndex DeserializeNameIndex(
+            const transport_catalogue_serialize::NameIndex& name_index_serialized,
+            const std::deque<Item>& items
+            );
+    spatial::GridIndex DeserializeStopGrid(
+            const transport_catalogue_serialize::StopGrid& stop_grid_serialized,
+            const transport_catalogue::TransportCatalogue& transport_catalogue
+            );
     renderer::RenderSettings DeserializeRenderSettings(const transport_catalogue_serialize::RenderSettings& render_settings_serialized);
     transport_router::RoutingSettings DeserializeRoutingSettings(const transport_catalogue_serialize::RoutingSettings& router_settings_serialized);
     std::unique_ptr<Graph> DeserializeGraph(const transport_catalogue_serialize::Graph& graph_serialized);
-    std::unique_ptr<graph::Router<double>> DeserializeRouter(
+    template <typename MatrixWeight, typename SerializedWeights>
+    std::unique_ptr<graph::Router<double, MatrixWeight>> DeserializeRouter(
+            const SerializedWeights& weights_serialized,
             const transport_catalogue_serialize::Router& router_serialized,
             const Graph& graph
             );
+    transport_router::RouterEngine DeserializeRouterEngine(
+            const transport_catalogue_serialize::TransportRouter& transport_router_serialized,
+            const Graph& graph
+            );
     PairsOfVerticesMap DeserializePairsOfVertices(
             const transport_catalogue_serialize::TransportRouter& transport_router_serialized,
             const transport_catalogue::TransportCatalogue& transport_catalogue
             );
-    std::vector<transport_router::EdgeDescription> DeserializeEdgeDescriptions(
+    transport_router::EdgeRecords DeserializeEdgeRecords(
+            const transport_catalogue_serialize::EdgeRecords& edge_records_serialized
+            );
+    transport_router::AlternativeBuses DeserializeAlternativeBuses(
             const transport_catalogue_serialize::TransportRouter& transport_router_serialized,
             const transport_catalogue::TransportCatalogue& transport_catalogue
             );
+    transport_router::EngineEstimates DeserializeEngineEstimates(
+            const transport_catalogue_serialize::TransportRouter& transport_router_serialized
+            );
+
+    std::unique_ptr<graph::ContractionHierarchiesRouter<double>> DeserializeContractionHierarchies(
+            const transport_catalogue_serialize::ContractionHierarchies& contraction_hierarchies_serialized,
+            const Graph& graph
+            );
+    std::unique_ptr<graph::HubLabelsRouter<double>> DeserializeHubLabels(
+            const transport_catalogue_serialize::HubLabels& hub_labels_serialized,
+            const Graph& graph
+            );
+    std::unique_ptr<graph::AltRouter<double>> DeserializeAltLandmarks(
+            const transport_catalogue_serialize::AltLandmarks& alt_landmarks_serialized,
+            const Graph& graph
+            );
 
     transport_catalogue_serialize::Color ChangeColorFormatToProtoMessage(const svg::Color& color);
     svg::Color ChangeColorFormatToSVGColor(const transport_catalogue_serialize::Color& color_serialized);
-
-    template<typename InputIterator>
-    uint32_t CalcStopId(InputIterator first, InputIterator last, std::string_view name);
+    transport_catalogue_serialize::EngineType ChangeEngineTypeToProtoMessage(transport_router::EngineType engine);
+    transport_router::EngineType ChangeEngineTypeToRouterEngine(transport_catalogue_serialize::EngineType engine_serialized);
+    transport_catalogue_serialize::EdgeType ChangeEdgeTypeToProtoMessage(transport_router::EdgeType type);
+    transport_router::EdgeType ChangeEdgeTypeToRouterEdgeType(transport_catalogue_serialize::EdgeType type_serialized);
+    transport_catalogue_serialize::WeightType ChangeWeightTypeToProtoMessage(transport_router::WeightType weight_type);
+    transport_router::WeightType ChangeWeightTypeToRouterWeightType(transport_catalogue_serialize::WeightType weight_type_serialized);
 
     void SerializeTransportDataBase(EntitiesForSerialization entities, std::ostream& out) {
         transport_catalogue_serialize::DataBase db_serialized;
 
         transport_catalogue_serialize::TransportCatalogue transport_catalogue_serialized =
                 SerializeTransportCatalogue(entities.transport_catalogue_);
+        *transport_catalogue_serialized.mutable_stop_index() =
+                SerializeNameIndex(entities.frozen_transport_catalogue_.GetStopIndex());
+        *transport_catalogue_serialized.mutable_bus_index() =
+                SerializeNameIndex(entities.frozen_transport_catalogue_.GetBusIndex());
+        *transport_catalogue_serialized.mutable_stop_grid() =
+                SerializeStopGrid(entities.frozen_transport_catalogue_.GetStopGrid());
         transport_catalogue_serialize::RenderSettings render_settings_serialized =
                 SerializeRenderSettings(entities.render_settings_);
         transport_catalogue_serialize::TransportRouter transport_router_serialized =
@@ -56,16 +105,19 @@ namespace serialization {
         }
 
         std::unique_ptr<Graph> graph = DeserializeGraph(db_serialized.transport_router().graph());
-        std::unique_ptr<graph::Router<double>> router = DeserializeRouter(db_serialized.transport_router().router(), *graph);
+        transport_router::RouterEngine router = DeserializeRouterEngine(db_serialized.transport_router(), *graph);
 
         DataBase db{ DeserializeTransportCatalogue(db_serialized.transport_catalogue()),
+                     DeserializeFrozenTransportCatalogue(db_serialized.transport_catalogue(), db.transport_catalogue_),
                      DeserializeRenderSettings(db_serialized.render_settings()),
                     { DeserializeRoutingSettings(db_serialized.transport_router().routing_settings()),
                          db.transport_catalogue_,
                          std::move(graph),
                          std::move(router),
                          DeserializePairsOfVertices(db_serialized.transport_router(), db.transport_catalogue_),
-                         DeserializeEdgeDescriptions(db_serialized.transport_router(), db.transport_catalogue_)
+                         DeserializeEdgeRecords(db_serialized.transport_router().edge_records()),
+                         DeserializeAlternativeBuses(db_serialized.transport_router(), db.transport_catalogue_),
+                         DeserializeEngineEstimates(db_serialized.transport_router())
                      }};
         return db;
     }
@@ -77,7 +129,7 @@ namespace serialization {
         for (int i = 0; i < stops.size(); i++) {
             transport_catalogue_serialize::Stop stop_serialized;
             stop_serialized.set_id(i);
-            stop_serialized.set_name(stops[i].name_);
+            stop_serialized.set_name(std::string(stops[i].name_));
             stop_serialized.set_latitude(stops[i].latitude_);
             stop_serialized.set_longitude(stops[i].longitude_);
             *transport_catalogue_serialized.add_stops() = std::move(stop_serialized);
@@ -86,32 +138,55 @@ namespace serialization {
         auto& buses = transport_catalogue.GetBuses();
         for (const auto & bus : buses) {
             transport_catalogue_serialize::Bus bus_serialized;
-            bus_serialized.set_name(bus.name_);
+            bus_serialized.set_name(std::string(bus.name_));
             bus_serialized.set_unique_stops(bus.unique_stops_);
             bus_serialized.set_bus_type(bus.type_ == domain::BusType::REVERSE ?
                                         transport_catalogue_serialize::BusType::REVERSE :
                                         transport_catalogue_serialize::BusType::CIRCULAR);
             for (auto stop : bus.stops_) {
-                uint32_t stop_id = CalcStopId(stops.cbegin(), stops.cend(), stop->name_);
-                bus_serialized.add_stops(stop_id);
+                bus_serialized.add_stops(stop->id_);
             }
             *transport_catalogue_serialized.add_buses() = std::move(bus_serialized);
         }
 
-        auto& distances = transport_catalogue.GetDistancess();
-        for (auto [stops_pair, distance_between] : distances) {
-            transport_catalogue_serialize::Distance distance;
-            uint32_t stop_id_first = CalcStopId(stops.cbegin(), stops.cend(), stops_pair.first->name_);
-            uint32_t stop_id_second = CalcStopId(stops.cbegin(), stops.cend(), stops_pair.second->name_);
-            distance.set_stop_id_1(stop_id_first);
-            distance.set_stop_id_2(stop_id_second);
-            distance.set_distance(distance_between);
-            *transport_catalogue_serialized.add_distances() = std::move(distance);
+        for (const domain::Stop& stop : stops) {
+            for (const transport_catalogue::RoadDistance& road_distance : transport_catalogue.GetRoadDistances(stop.id_)) {
+                if (road_distance.is_reverse_) continue;
+                transport_catalogue_serialize::Distance distance;
+                distance.set_stop_id_1(stop.id_);
+                distance.set_stop_id_2(road_distance.to_);
+                distance.set_distance(road_distance.distance_);
+                *transport_catalogue_serialized.add_distances() = std::move(distance);
+            }
         }
 
         return transport_catalogue_serialized;
     }
 
+    transport_catalogue_serialize::NameIndex SerializeNameIndex(const perfect_hash::NameIndex& name_index) {
+        transport_catalogue_serialize::NameIndex name_index_serialized;
+        *name_index_serialized.mutable_seeds() = {name_index.GetSeeds().begin(), name_index.GetSeeds().end()};
+        *name_index_serialized.mutable_slot_ids() = {name_index.GetSlotIds().begin(), name_index.GetSlotIds().end()};
+        return name_index_serialized;
+    }
+
+    // The coordinates are left to the stops of the catalogue, only the stop ids are stored in cell order.
+    transport_catalogue_serialize::StopGrid SerializeStopGrid(const spatial::GridIndex& stop_grid) {
+        transport_catalogue_serialize::StopGrid stop_grid_serialized;
+        const spatial::GridLayout& layout = stop_grid.GetLayout();
+        stop_grid_serialized.set_min_latitude(layout.min.lat);
+        stop_grid_serialized.set_min_longitude(layout.min.lng);
+        stop_grid_serialized.set_cell_height(layout.cell_height);
+        stop_grid_serialized.set_cell_width(layout.cell_width);
+        stop_grid_serialized.set_rows(layout.rows);
+        stop_grid_serialized.set_columns(layout.columns);
+        *stop_grid_serialized.mutable_cell_offsets() = {stop_grid.GetCellOffsets().begin(), stop_grid.GetCellOffsets().end()};
+        for (const spatial::Point& point : stop_grid.GetPoints()) {
+            stop_grid_serialized.add_stop_ids(point.id);
+        }
+        return stop_grid_serialized;
+    }
+
     transport_catalogue_serialize::RenderSettings SerializeRenderSettings(const renderer::RenderSettings& render_settings) {
         transport_catalogue_serialize::RenderSettings render_settings_serialized;
         render_settings_serialized.set_width(render_settings.width_);
@@ -152,40 +227,93 @@ namespace serialization {
         transport_catalogue_serialize::RoutingSettings router_settings_serialized;
         router_settings_serialized.set_bus_wait_time(transport_router.GetRoutingSettings().bus_wait_time_);
         router_settings_serialized.set_bus_velocity(transport_router.GetRoutingSettings().bus_velocity_);
+        router_settings_serialized.set_engine(ChangeEngineTypeToProtoMessage(transport_router.GetRoutingSettings().engine_));
+        router_settings_serialized.set_route_cache_capacity(transport_router.GetRoutingSettings().route_cache_capacity_);
+        router_settings_serialized.set_weight_type(ChangeWeightTypeToProtoMessage(transport_router.GetRoutingSettings().weight_type_));
+        router_settings_serialized.set_landmark_count(transport_router.GetRoutingSettings().landmark_count_);
+        router_settings_serialized.set_max_memory_mb(transport_router.GetRoutingSettings().max_memory_mb_);
+        router_settings_serialized.set_max_build_seconds(transport_router.GetRoutingSettings().max_build_seconds_);
+        router_settings_serialized.set_max_transfers(transport_router.GetRoutingSettings().max_transfers_);
+        router_settings_serialized.set_graph_model(transport_router.GetRoutingSettings().graph_model_ == transport_router::GraphModel::TRIP_BASED ?
+                                                   transport_catalogue_serialize::GraphModel::TRIP_BASED :
+                                                   transport_catalogue_serialize::GraphModel::COMPLETE);
         *transport_router_serialized.mutable_routing_settings() = std::move(router_settings_serialized);
 
         transport_catalogue_serialize::Graph graph_serialized = transport_router.GetGraph()->GetSerializedGraph();
         *transport_router_serialized.mutable_graph() = std::move(graph_serialized);
-        transport_catalogue_serialize::Router router_serialized = transport_router.GetRouter()->GetSerializedRouter();
-        *transport_router_serialized.mutable_router() = std::move(router_serialized);
+        if (transport_router.GetRoutingSettings().engine_ == transport_router::EngineType::RAPTOR) {
+            // RAPTOR precomputes nothing, process_requests sets it up from the catalogue again.
+        } else if (auto router = std::get_if<std::unique_ptr<transport_router::Router>>(&transport_router.GetRouter())) {
+            transport_catalogue_serialize::Router router_serialized = (*router)->GetSerializedRouter();
+            *transport_router_serialized.mutable_router() = std::move(router_serialized);
+        } else if (auto float_router = std::get_if<std::unique_ptr<transport_router::FloatRouter>>(&transport_router.GetRouter())) {
+            transport_catalogue_serialize::Router router_serialized = (*float_router)->GetSerializedRouter();
+            *transport_router_serialized.mutable_router() = std::move(router_serialized);
+        } else if (auto fixed_point_router = std::get_if<std::unique_ptr<transport_router::FixedPointRouter>>(&transport_router.GetRouter())) {
+            transport_catalogue_serialize::Router router_serialized = (*fixed_point_router)->GetSerializedRouter();
+            *transport_router_serialized.mutable_router() = std::move(router_serialized);
+        } else if (auto contraction_hierarchies = std::get_if<std::unique_ptr<transport_router::ContractionHierarchiesRouter>>(&transport_router.GetRouter())) {
+            transport_catalogue_serialize::ContractionHierarchies contraction_hierarchies_serialized =
+                    (*contraction_hierarchies)->GetSerializedContractionHierarchies();
+            *transport_router_serialized.mutable_contraction_hierarchies() = std::move(contraction_hierarchies_serialized);
+        } else if (auto hub_labels = std::get_if<std::unique_ptr<transport_router::HubLabelsRouter>>(&transport_router.GetRouter())) {
+            transport_catalogue_serialize::HubLabels hub_labels_serialized = (*hub_labels)->GetSerializedHubLabels();
+            *transport_router_serialized.mutable_hub_labels() = std::move(hub_labels_serialized);
+        } else if (auto alt_router = std::get_if<std::unique_ptr<transport_router::AltRouter>>(&transport_router.GetRouter())) {
+            transport_catalogue_serialize::AltLandmarks alt_landmarks_serialized = (*alt_router)->GetSerializedAltLandmarks();
+            *transport_router_serialized.mutable_alt_landmarks() = std::move(alt_landmarks_serialized);
+        }
 
+        for (const auto& estimate : transport_router.GetEngineEstimates()) {
+            transport_catalogue_serialize::EngineEstimate estimate_serialized;
+            estimate_serialized.set_engine(ChangeEngineTypeToProtoMessage(estimate.engine_));
+            estimate_serialized.set_memory_mb(estimate.memory_mb_);
+            estimate_serialized.set_build_seconds(estimate.build_seconds_);
+            estimate_serialized.set_fits(estimate.fits_);
+            *transport_router_serialized.add_engine_estimates() = std::move(estimate_serialized);
+        }
 
-        for (auto pair : transport_router.GetPairsOfVertices()) {
+        const auto& pairs_of_vertices = transport_router.GetPairsOfVertices();
+        const std::vector<std::string_view> stop_names = transport_router.GetTransportCatalogue().GetUsedStopNames();
+        for (uint32_t stop_index = 0; stop_index < stop_names.size(); ++stop_index) {
+            const auto& [id_from, id_to] = pairs_of_vertices.at(stop_names[stop_index]);
             transport_catalogue_serialize::PairOfVertices pair_of_vertices_serialized;
-            pair_of_vertices_serialized.set_name(std::string (pair.first));
-            pair_of_vertices_serialized.set_id_from(pair.second.first);
-            pair_of_vertices_serialized.set_id_to(pair.second.second);
+            pair_of_vertices_serialized.set_stop_index(stop_index);
+            pair_of_vertices_serialized.set_id_from(id_from);
+            pair_of_vertices_serialized.set_id_to(id_to);
             *transport_router_serialized.add_pairs_of_vertices() = std::move(pair_of_vertices_serialized);
         }
 
-        for (auto& edge_description : transport_router.GetEdgeDescriptions()) {
-            transport_catalogue_serialize::EdgeDescription edge_description_serialized;
-            edge_description_serialized.set_type(edge_description.type_ == transport_router::EdgeType::WAIT ?
-                                                 transport_catalogue_serialize::EdgeType::WAIT :
-                                                 transport_catalogue_serialize::EdgeType::BUS);
-            edge_description_serialized.set_edge_name(std::string(edge_description.edge_name_));
-            edge_description_serialized.set_time(edge_description.time_);
-            if (edge_description.span_count_.has_value()) {
-                transport_catalogue_serialize::SpanCount span_count_serialized;
-                span_count_serialized.set_has_value(true);
-                span_count_serialized.set_span_count(edge_description.span_count_.value());
-                *edge_description_serialized.mutable_span_count() = std::move(span_count_serialized);
-            } else {
-                transport_catalogue_serialize::SpanCount span_count_serialized;
-                span_count_serialized.set_has_value(false);
-                *edge_description_serialized.mutable_span_count() = std::move(span_count_serialized);
+        const auto& edge_records = transport_router.GetEdgeRecords();
+        transport_catalogue_serialize::EdgeRecords edge_records_serialized;
+        edge_records_serialized.mutable_types()->Reserve(static_cast<int>(edge_records.size()));
+        edge_records_serialized.mutable_indices()->Reserve(static_cast<int>(edge_records.size()));
+        edge_records_serialized.mutable_first_stops()->Reserve(static_cast<int>(edge_records.size()));
+        edge_records_serialized.mutable_span_counts()->Reserve(static_cast<int>(edge_records.size()));
+        for (const auto& edge_record : edge_records) {
+            edge_records_serialized.add_types(ChangeEdgeTypeToProtoMessage(edge_record.type_));
+            edge_records_serialized.add_indices(edge_record.index_);
+            edge_records_serialized.add_first_stops(edge_record.first_stop_);
+            edge_records_serialized.add_span_counts(edge_record.span_count_);
+        }
+        *transport_router_serialized.mutable_edge_records() = std::move(edge_records_serialized);
+
+        // A removed bus keeps its index with no stops and its name may be taken by a later bus.
+        std::unordered_map<std::string_view, uint32_t> bus_indices;
+        uint32_t bus_index = 0;
+        for (const domain::Bus& bus : transport_router.GetTransportCatalogue().GetBuses()) {
+            if (!bus.stops_.empty()) {
+                bus_indices.emplace(bus.name_, bus_index);
+            }
+            ++bus_index;
+        }
+        for (const auto& [edge_id, bus_names] : transport_router.GetAlternativeBuses()) {
+            transport_catalogue_serialize::AlternativeBuses alternative_buses_serialized;
+            alternative_buses_serialized.set_edge_id(edge_id);
+            for (std::string_view bus_name : bus_names) {
+                alternative_buses_serialized.add_bus_indices(bus_indices.at(bus_name));
             }
-            *transport_router_serialized.add_edges_description() = std::move(edge_description_serialized);
+            *transport_router_serialized.add_alternative_buses() = std::move(alternative_buses_serialized);
         }
 
         return transport_router_serialized;
@@ -209,18 +337,71 @@ namespace serialization {
             std::string name = bus_serialized.name();
             std::vector<std::string> stops_of_bus;
             for (auto stop_id : bus_serialized.stops()) {
-                std::string stop_name = stops[stop_id].name_;
+                std::string stop_name(stops[stop_id].name_);
                 stops_of_bus.push_back(stop_name);
             }
             domain::BusType type = bus_serialized.bus_type() == transport_catalogue_serialize::BusType::REVERSE ?
                                                                 domain::BusType::REVERSE :
                                                                 domain::BusType::CIRCULAR;
-            transport_catalogue.AddBus({std::move(name), std::move(stops_of_bus), type});
+            const bool removed = stops_of_bus.empty();
+            transport_catalogue.AddBus({name, std::move(stops_of_bus), type});
+            if (removed) {
+                transport_catalogue.RemoveBus(name);
+            }
         }
 
         return transport_catalogue;
     }
 
+    // The names come from the catalogue in slot order, so the hashes are not searched for again.
+    // A base written without the indexes gets them built anew.
+    transport_catalogue::FrozenTransportCatalogue DeserializeFrozenTransportCatalogue(
+            const transport_catalogue_serialize::TransportCatalogue& transport_catalogue_serialized,
+            const transport_catalogue::TransportCatalogue& transport_catalogue
+            ) {
+        if (!transport_catalogue_serialized.has_stop_index() || !transport_catalogue_serialized.has_bus_index()
+            || !transport_catalogue_serialized.has_stop_grid()) {
+            return transport_catalogue::FrozenTransportCatalogue{transport_catalogue};
+        }
+        return {transport_catalogue,
+                DeserializeNameIndex(transport_catalogue_serialized.stop_index(), transport_catalogue.GetStops()),
+                DeserializeNameIndex(transport_catalogue_serialized.bus_index(), transport_catalogue.GetBuses()),
+                DeserializeStopGrid(transport_catalogue_serialized.stop_grid(), transport_catalogue)};
+    }
+
+    spatial::GridIndex DeserializeStopGrid(
+            const transport_catalogue_serialize::StopGrid& stop_grid_serialized,
+            const transport_catalogue::TransportCatalogue& transport_catalogue
+            ) {
+        std::vector<spatial::Point> points;
+        points.reserve(stop_grid_serialized.stop_ids_size());
+        for (uint32_t stop_id : stop_grid_serialized.stop_ids()) {
+            const domain::Stop& stop = transport_catalogue.GetStops().at(stop_id);
+            points.push_back({stop_id, {stop.latitude_, stop.longitude_}});
+        }
+        spatial::GridLayout layout{{stop_grid_serialized.min_latitude(), stop_grid_serialized.min_longitude()},
+                                   stop_grid_serialized.cell_height(), stop_grid_serialized.cell_width(),
+                                   stop_grid_serialized.rows(), stop_grid_serialized.columns()};
+        return {layout,
+                {stop_grid_serialized.cell_offsets().begin(), stop_grid_serialized.cell_offsets().end()},
+                std::move(points)};
+    }
+
+    template <typename Item>
+    perfect_hash::NameIndex DeserializeNameIndex(
+            const transport_catalogue_serialize::NameIndex& name_index_serialized,
+            const std::deque<Item>& items
+            ) {
+        std::vector<std::string_view> slot_names;
+        slot_names.reserve(name_index_serialized.slot_ids_size());
+        for (uint32_t id : name_index_serialized.slot_ids()) {
+            slot_names.push_back(items.at(id).name_);
+        }
+        return {{name_index_serialized.seeds().begin(), name_index_serialized.seeds().end()},
+                slot_names,
+                {name_index_serialized.slot_ids().begin(), name_index_serialized.slot_ids().end()}};
+    }
+
     renderer::RenderSettings DeserializeRenderSettings(const transport_catalogue_serialize::RenderSettings& render_settings_serialized) {
         renderer::RenderSettings render_settings;
         render_settings.width_ = render_settings_serialized.width();
@@ -243,104 +424,162 @@ namespace serialization {
     }
 
     std::unique_ptr<Graph> DeserializeGraph(const transport_catalogue_serialize::Graph& graph_serialized) {
-        std::vector<graph::Edge<double>> edges;
-        edges.reserve(graph_serialized.edges_size());
-        for (auto& edge_serialized : graph_serialized.edges()) {
-            graph::Edge<double> edge{edge_serialized.from_id(), edge_serialized.to_id(), edge_serialized.weight()};
-            edges.push_back(edge);
-        }
-
-        std::vector<std::vector<VertexId>> incidence_lists;
-        incidence_lists.reserve(graph_serialized.incidence_lists_size());
-        for (auto& incidence_list_serialized : graph_serialized.incidence_lists()) {
-            std::vector<VertexId> incidence_list;
-            incidence_list.reserve(incidence_list_serialized.edge_ids_size());
-            for (auto id : incidence_list_serialized.edge_ids()) {
-                incidence_list.push_back(id);
-            }
-            incidence_lists.push_back(std::move(incidence_list));
+        return std::make_unique<Graph>(std::vector<size_t>(graph_serialized.offsets().begin(), graph_serialized.offsets().end()),
+                                       std::vector<VertexId>(graph_serialized.targets().begin(), graph_serialized.targets().end()),
+                                       std::vector<double>(graph_serialized.weights().begin(), graph_serialized.weights().end()));
+    }
+
+    template <typename MatrixWeight, typename SerializedWeights>
+    std::unique_ptr<graph::Router<double, MatrixWeight>> DeserializeRouter(const SerializedWeights& weights_serialized,
+                                                                           const transport_catalogue_serialize::Router& router_serialized,
+                                                                           const Graph& graph) {
+        typename graph::Router<double, MatrixWeight>::RoutesInternalData routes_internal_data{
+            {weights_serialized.begin(), weights_serialized.end()},
+            {router_serialized.prev_edges().begin(), router_serialized.prev_edges().end()}
+        };
+        return std::make_unique<graph::Router<double, MatrixWeight>>(graph, std::move(routes_internal_data));
+    }
+
+    transport_router::RouterEngine DeserializeRouterEngine(const transport_catalogue_serialize::TransportRouter& transport_router_serialized,
+                                                           const Graph& graph) {
+        switch (transport_router_serialized.routing_settings().engine()) {
+            case transport_catalogue_serialize::EngineType::DIJKSTRA:
+                return std::make_unique<transport_router::DijkstraRouter>(graph);
+            case transport_catalogue_serialize::EngineType::CONTRACTION_HIERARCHIES:
+                return DeserializeContractionHierarchies(transport_router_serialized.contraction_hierarchies(), graph);
+            case transport_catalogue_serialize::EngineType::HUB_LABELS:
+                return DeserializeHubLabels(transport_router_serialized.hub_labels(), graph);
+            case transport_catalogue_serialize::EngineType::ALT:
+                return DeserializeAltLandmarks(transport_router_serialized.alt_landmarks(), graph);
+            case transport_catalogue_serialize::EngineType::RAPTOR:
+                return transport_router::RouterEngine{};
+            default:
+                break;
         }
+        const transport_catalogue_serialize::Router& router_serialized = transport_router_serialized.router();
+        switch (transport_router_serialized.routing_settings().weight_type()) {
+            case transport_catalogue_serialize::WeightType::FLOAT:
+                return DeserializeRouter<float>(router_serialized.float_weights(), router_serialized, graph);
+            case transport_catalogue_serialize::WeightType::FIXED_POINT:
+                return DeserializeRouter<uint32_t>(router_serialized.fixed_point_weights(), router_serialized, graph);
+            default:
+                return DeserializeRouter<double>(router_serialized.weights(), router_serialized, graph);
+        }
+    }
 
-        return std::make_unique<Graph>(std::move(edges), std::move(incidence_lists));
+    std::unique_ptr<graph::ContractionHierarchiesRouter<double>> DeserializeContractionHierarchies(
+            const transport_catalogue_serialize::ContractionHierarchies& contraction_hierarchies_serialized,
+            const Graph& graph) {
+        std::vector<size_t> ranks(contraction_hierarchies_serialized.ranks().begin(),
+                                  contraction_hierarchies_serialized.ranks().end());
+        std::vector<graph::ContractionHierarchiesRouter<double>::Shortcut> shortcuts;
+        shortcuts.reserve(contraction_hierarchies_serialized.shortcuts_size());
+        for (auto& shortcut_serialized : contraction_hierarchies_serialized.shortcuts()) {
+            shortcuts.push_back({shortcut_serialized.from_id(),
+                                 shortcut_serialized.to_id(),
+                                 shortcut_serialized.weight(),
+                                 shortcut_serialized.first_edge_id(),
+                                 shortcut_serialized.second_edge_id()});
+        }
+        return std::make_unique<graph::ContractionHierarchiesRouter<double>>(graph, std::move(ranks), std::move(shortcuts));
     }
 
-    std::unique_ptr<graph::Router<double>> DeserializeRouter(const transport_catalogue_serialize::Router& router_serialized, const Graph& graph) {
-        std::vector<std::vector<std::optional<graph::Router<double>::RouteInternalData>>> array_routes_internal_data;
-        for (auto& routes_of_internal_data_serialized : router_serialized.array_of_routes_internal_data()) {
-            std::vector<std::optional<graph::Router<double>::RouteInternalData>> routes_of_internal_data;
-            routes_of_internal_data.reserve(routes_of_internal_data_serialized.routes_internal_data_size());
-            for (auto& route_internal_data_serialized : routes_of_internal_data_serialized.routes_internal_data()) {
-                std::optional<graph::Router<double>::RouteInternalData> route_internal_data;
-                if (route_internal_data_serialized.has_value()) {
-                    graph::Router<double>::RouteInternalData routeInternalData;
-                    routeInternalData.weight = route_internal_data_serialized.weight();
-                    if (route_internal_data_serialized.prev_edge().has_value()) {
-                        routeInternalData.prev_edge = route_internal_data_serialized.prev_edge().prev_edge();
-                    }
-                    route_internal_data = routeInternalData;
-                }
-                routes_of_internal_data.push_back(route_internal_data);
+    std::unique_ptr<graph::HubLabelsRouter<double>> DeserializeHubLabels(
+            const transport_catalogue_serialize::HubLabels& hub_labels_serialized,
+            const Graph& graph) {
+        auto deserialize_labels = [](const transport_catalogue_serialize::Labels& labels_serialized) {
+            if (labels_serialized.weights_size() != labels_serialized.hubs_size()
+                || labels_serialized.edges_size() != labels_serialized.hubs_size()) {
+                throw std::runtime_error("Serialized hub labels are inconsistent");
             }
-            array_routes_internal_data.push_back(std::move(routes_of_internal_data));
-        }
-        return std::make_unique<graph::Router<double>>(graph::Router<double>{graph, std::move(array_routes_internal_data)});
+            graph::HubLabelsRouter<double>::Labels labels;
+            labels.offsets.assign(labels_serialized.offsets().begin(), labels_serialized.offsets().end());
+            labels.entries.reserve(labels_serialized.hubs_size());
+            for (int i = 0; i < labels_serialized.hubs_size(); ++i) {
+                labels.entries.push_back({labels_serialized.weights(i), labels_serialized.hubs(i), labels_serialized.edges(i)});
+            }
+            return labels;
+        };
+        return std::make_unique<graph::HubLabelsRouter<double>>(graph,
+                                                                 deserialize_labels(hub_labels_serialized.out_labels()),
+                                                                 deserialize_labels(hub_labels_serialized.in_labels()));
+    }
+
+    std::unique_ptr<graph::AltRouter<double>> DeserializeAltLandmarks(
+            const transport_catalogue_serialize::AltLandmarks& alt_landmarks_serialized,
+            const Graph& graph) {
+        graph::AltRouter<double>::LandmarkDistances landmark_distances{
+            {alt_landmarks_serialized.landmarks().begin(), alt_landmarks_serialized.landmarks().end()},
+            {alt_landmarks_serialized.from_landmarks().begin(), alt_landmarks_serialized.from_landmarks().end()},
+            {alt_landmarks_serialized.to_landmarks().begin(), alt_landmarks_serialized.to_landmarks().end()}
+        };
+        return std::make_unique<graph::AltRouter<double>>(graph, std::move(landmark_distances));
     }
 
     transport_router::RoutingSettings DeserializeRoutingSettings(const transport_catalogue_serialize::RoutingSettings& router_settings_serialized) {
         transport_router::RoutingSettings routing_settings;
         routing_settings.bus_wait_time_ = router_settings_serialized.bus_wait_time();
         routing_settings.bus_velocity_ = router_settings_serialized.bus_velocity();
+        routing_settings.engine_ = ChangeEngineTypeToRouterEngine(router_settings_serialized.engine());
+        routing_settings.route_cache_capacity_ = router_settings_serialized.route_cache_capacity();
+        routing_settings.weight_type_ = ChangeWeightTypeToRouterWeightType(router_settings_serialized.weight_type());
+        routing_settings.landmark_count_ = router_settings_serialized.landmark_count();
+        routing_settings.max_memory_mb_ = router_settings_serialized.max_memory_mb();
+        routing_settings.max_build_seconds_ = router_settings_serialized.max_build_seconds();
+        routing_settings.max_transfers_ = router_settings_serialized.max_transfers();
+        routing_settings.graph_model_ = router_settings_serialized.graph_model() == transport_catalogue_serialize::GraphModel::TRIP_BASED ?
+                                                                                   transport_router::GraphModel::TRIP_BASED :
+                                                                                   transport_router::GraphModel::COMPLETE;
         return routing_settings;
     }
 
     PairsOfVerticesMap DeserializePairsOfVertices(const transport_catalogue_serialize::TransportRouter& transport_router_serialized,
                                                   const transport_catalogue::TransportCatalogue& transport_catalogue) {
         PairsOfVerticesMap pairs_of_vertices_for_each_stop;
-        const auto& stop_names = transport_catalogue.GetUsedStopNames();
+        pairs_of_vertices_for_each_stop.reserve(transport_router_serialized.pairs_of_vertices_size());
+        const std::vector<std::string_view> stop_names = transport_catalogue.GetUsedStopNames();
         for (auto& pair : transport_router_serialized.pairs_of_vertices()) {
-            auto stop_name_iter = std::find(stop_names.begin(), stop_names.end(), pair.name());
-            std::pair<std::string_view, std::pair<VertexId, VertexId>> pair_of_vertices{*stop_name_iter, {pair.id_from(), pair.id_to()}};
-            pairs_of_vertices_for_each_stop.insert(std::move(pair_of_vertices));
+            pairs_of_vertices_for_each_stop.insert({stop_names.at(pair.stop_index()), {pair.id_from(), pair.id_to()}});
         }
         return pairs_of_vertices_for_each_stop;
     }
 
-    std::vector<transport_router::EdgeDescription> DeserializeEdgeDescriptions(const transport_catalogue_serialize::TransportRouter& transport_router_serialized,
-                                                                               const transport_catalogue::TransportCatalogue& transport_catalogue) {
-        std::vector<transport_router::EdgeDescription> edges_description;
-        edges_description.reserve(transport_router_serialized.edges_description_size());
-        const auto& stop_names = transport_catalogue.GetUsedStopNames();
-        const auto& bus_names = transport_catalogue.GetBuses();
-        for (auto& edge_description_serialized : transport_router_serialized.edges_description()) {
-            transport_router::EdgeDescription edge_description;
-            edge_description.type_ = edge_description_serialized.type() == transport_catalogue_serialize::EdgeType::BUS ?
-                                                                           transport_router::EdgeType::BUS :
-                                                                           transport_router::EdgeType::WAIT;
-            edge_description.time_ = edge_description_serialized.time();
-            if (edge_description.type_ == transport_router::EdgeType::WAIT) {
-                edge_description.edge_name_ = *(std::find(stop_names.begin(), stop_names.end(), edge_description_serialized.edge_name()));
-            } else {
-                std::string_view str_to_find = edge_description_serialized.edge_name();
-                edge_description.edge_name_ = (std::find_if(bus_names.begin(), bus_names.end(), [str_to_find](const domain::Bus& bus){
-                    return bus.name_ == str_to_find;
-                }))->name_;
-            }
-            if (edge_description_serialized.span_count().has_value()) {
-                edge_description.span_count_ = edge_description_serialized.span_count().span_count();
-            } else {
-                edge_description.span_count_ = std::nullopt;
+    transport_router::EdgeRecords DeserializeEdgeRecords(const transport_catalogue_serialize::EdgeRecords& edge_records_serialized) {
+        transport_router::EdgeRecords edge_records;
+        edge_records.reserve(edge_records_serialized.types_size());
+        for (int i = 0; i < edge_records_serialized.types_size(); ++i) {
+            edge_records.push_back({ChangeEdgeTypeToRouterEdgeType(edge_records_serialized.types(i)),
+                                    edge_records_serialized.indices(i),
+                                    edge_records_serialized.first_stops(i),
+                                    edge_records_serialized.span_counts(i)});
+        }
+        return edge_records;
+    }
+
+    transport_router::AlternativeBuses DeserializeAlternativeBuses(const transport_catalogue_serialize::TransportRouter& transport_router_serialized,
+                                                                   const transport_catalogue::TransportCatalogue& transport_catalogue) {
+        transport_router::AlternativeBuses alternative_buses;
+        alternative_buses.reserve(transport_router_serialized.alternative_buses_size());
+        for (const auto& alternative_buses_serialized : transport_router_serialized.alternative_buses()) {
+            auto& bus_names = alternative_buses[alternative_buses_serialized.edge_id()];
+            bus_names.reserve(alternative_buses_serialized.bus_indices_size());
+            for (uint32_t bus_index : alternative_buses_serialized.bus_indices()) {
+                bus_names.push_back(transport_catalogue.GetBuses().at(bus_index).name_);
             }
-            edges_description.push_back(edge_description);
         }
-        return edges_description;
+        return alternative_buses;
     }
 
-    template<typename InputIterator>
-    uint32_t CalcStopId(InputIterator first, InputIterator last, std::string_view name) {
-        auto stop_iterator = std::find_if(first, last, [&name](const domain::Stop stop_elem){
-            return stop_elem.name_ == name;
-        });
-        return std::distance(first, stop_iterator);
+    transport_router::EngineEstimates DeserializeEngineEstimates(const transport_catalogue_serialize::TransportRouter& transport_router_serialized) {
+        transport_router::EngineEstimates estimates;
+        estimates.reserve(transport_router_serialized.engine_estimates_size());
+        for (const auto& estimate_serialized : transport_router_serialized.engine_estimates()) {
+            estimates.push_back({ChangeEngineTypeToRouterEngine(estimate_serialized.engine()),
+                                 estimate_serialized.memory_mb(),
+                                 estimate_serialized.build_seconds(),
+                                 estimate_serialized.fits()});
+        }
+        return estimates;
     }
 
     transport_catalogue_serialize::Color ChangeColorFormatToProtoMessage(const svg::Color& color) {
@@ -384,4 +623,82 @@ namespace serialization {
         }
         return color;
     }
-}
\ No newline at end of file
+
+    transport_catalogue_serialize::EngineType ChangeEngineTypeToProtoMessage(transport_router::EngineType engine) {
+        switch (engine) {
+            case transport_router::EngineType::DIJKSTRA:
+                return transport_catalogue_serialize::EngineType::DIJKSTRA;
+            case transport_router::EngineType::CONTRACTION_HIERARCHIES:
+                return transport_catalogue_serialize::EngineType::CONTRACTION_HIERARCHIES;
+            case transport_router::EngineType::HUB_LABELS:
+                return transport_catalogue_serialize::EngineType::HUB_LABELS;
+            case transport_router::EngineType::ALT:
+                return transport_catalogue_serialize::EngineType::ALT;
+            case transport_router::EngineType::RAPTOR:
+                return transport_catalogue_serialize::EngineType::RAPTOR;
+            default:
+                return transport_catalogue_serialize::EngineType::ALL_PAIRS;
+        }
+    }
+
+    transport_router::EngineType ChangeEngineTypeToRouterEngine(transport_catalogue_serialize::EngineType engine_serialized) {
+        switch (engine_serialized) {
+            case transport_catalogue_serialize::EngineType::DIJKSTRA:
+                return transport_router::EngineType::DIJKSTRA;
+            case transport_catalogue_serialize::EngineType::CONTRACTION_HIERARCHIES:
+                return transport_router::EngineType::CONTRACTION_HIERARCHIES;
+            case transport_catalogue_serialize::EngineType::HUB_LABELS:
+                return transport_router::EngineType::HUB_LABELS;
+            case transport_catalogue_serialize::EngineType::ALT:
+                return transport_router::EngineType::ALT;
+            case transport_catalogue_serialize::EngineType::RAPTOR:
+                return transport_router::EngineType::RAPTOR;
+            default:
+                return transport_router::EngineType::ALL_PAIRS;
+        }
+    }
+
+    transport_catalogue_serialize::EdgeType ChangeEdgeTypeToProtoMessage(transport_router::EdgeType type) {
+        switch (type) {
+            case transport_router::EdgeType::BUS:
+                return transport_catalogue_serialize::EdgeType::BUS;
+            case transport_router::EdgeType::ALIGHT:
+                return transport_catalogue_serialize::EdgeType::ALIGHT;
+            default:
+                return transport_catalogue_serialize::EdgeType::WAIT;
+        }
+    }
+
+    transport_router::EdgeType ChangeEdgeTypeToRouterEdgeType(transport_catalogue_serialize::EdgeType type_serialized) {
+        switch (type_serialized) {
+            case transport_catalogue_serialize::EdgeType::BUS:
+                return transport_router::EdgeType::BUS;
+            case transport_catalogue_serialize::EdgeType::ALIGHT:
+                return transport_router::EdgeType::ALIGHT;
+            default:
+                return transport_router::EdgeType::WAIT;
+        }
+    }
+
+    transport_catalogue_serialize::WeightType ChangeWeightTypeToProtoMessage(transport_router::WeightType weight_type) {
+        switch (weight_type) {
+            case transport_router::WeightType::FLOAT:
+                return transport_catalogue_serialize::WeightType::FLOAT;
+            case transport_router::WeightType::FIXED_POINT:
+                return transport_catalogue_serialize::WeightType::FIXED_POINT;
+            default:
+                return transport_catalogue_serialize::WeightType::DOUBLE;
+        }
+    }
+
+    transport_router::WeightType ChangeWeightTypeToRouterWeightType(transport_catalogue_serialize::WeightType weight_type_serialized) {
+        switch (weight_type_serialized) {
+            case transport_catalogue_serialize::WeightType::FLOAT:
+                return transport_router::WeightType::FLOAT;
+            case transport_catalogue_serialize::WeightType::FIXED_POINT:
+                return transport_router::WeightType::FIXED_POINT;
+            default:
+                return transport_router::WeightType::DOUBLE;
+        }
+    }
+}
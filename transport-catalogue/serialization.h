@@ -18,12 +18,14 @@ namespace serialization {
 
     struct EntitiesForSerialization {
         const transport_catalogue::TransportCatalogue& transport_catalogue_;
+        const transport_catalogue::FrozenTransportCatalogue& frozen_transport_catalogue_;
         const renderer::RenderSettings& render_settings_;
         const transport_router::TransportRouter& transport_router_;
     };
 
     struct DataBase {
         transport_catalogue::TransportCatalogue transport_catalogue_;
+        transport_catalogue::FrozenTransportCatalogue frozen_transport_catalogue_;
         renderer::RenderSettings render_settings_;
         transport_router::TransportRouter transport_router_;
     };
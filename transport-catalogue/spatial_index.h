@@ -0,0 +1,214 @@
+#pragma once
+
+#include "geo.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace spatial {
+
+    struct Point {
+        uint32_t id;
+        geo::Coordinates coordinates;
+    };
+
+    struct Neighbour {
+        uint32_t id;
+        double distance;
+    };
+
+    // Rows go along the latitude.
+    struct GridLayout {
+        geo::Coordinates min;
+        double cell_height;
+        double cell_width;
+        uint32_t rows;
+        uint32_t columns;
+    };
+
+    // Uniform grid over geographic points, stored cell after cell.
+    class GridIndex {
+    public:
+        static constexpr double EARTH_RADIUS = 6371000.0;
+
+        GridIndex() = default;
+        explicit GridIndex(std::vector<Point> points);
+        // From a stored layout and the points in cell order.
+        GridIndex(GridLayout layout, std::vector<uint32_t> cell_offsets, std::vector<Point> points);
+
+        // Nearest first, ties by id.
+        std::vector<Neighbour> FindWithinRadius(geo::Coordinates center, double radius) const;
+        std::vector<Neighbour> FindNearest(geo::Coordinates center, size_t count,
+                                           double max_radius = std::numeric_limits<double>::infinity()) const;
+
+        const GridLayout& GetLayout() const &;
+        const std::vector<uint32_t>& GetCellOffsets() const &;
+        const std::vector<Point>& GetPoints() const &;
+
+    private:
+        static constexpr size_t POINTS_PER_CELL = 2;
+        // Covers the rounding error of geo::ComputeDistance.
+        static constexpr double BOX_MARGIN = 1.0;
+
+        GridLayout layout_{{0.0, 0.0}, 1.0, 1.0, 0, 0};
+        std::vector<uint32_t> cell_offsets_;
+        std::vector<Point> points_;
+
+        uint32_t GetRow(double lat) const;
+        uint32_t GetColumn(double lng) const;
+        void CollectBox(geo::Coordinates center, double radius, double min_lat, double max_lat,
+                        double min_lng, double max_lng, std::vector<Neighbour>& result) const;
+    };
+
+    inline GridIndex::GridIndex(std::vector<Point> points) {
+        if (points.empty()) {
+            cell_offsets_.assign(1, 0);
+            return;
+        }
+        geo::Coordinates min = points.front().coordinates;
+        geo::Coordinates max = min;
+        for (const Point& point : points) {
+            min = {std::min(min.lat, point.coordinates.lat), std::min(min.lng, point.coordinates.lng)};
+            max = {std::max(max.lat, point.coordinates.lat), std::max(max.lng, point.coordinates.lng)};
+        }
+        // Square on the ground, not in degrees.
+        const double height = std::max(max.lat - min.lat, geo::EPSILON);
+        const double width = std::max((max.lng - min.lng) * std::cos((min.lat + max.lat) / 2 * M_PI / 180), geo::EPSILON);
+        const double cell_count = std::max<double>(1.0, static_cast<double>(points.size()) / POINTS_PER_CELL);
+        const double side = std::sqrt(height * width / cell_count);
+        layout_.min = min;
+        layout_.rows = static_cast<uint32_t>(std::clamp(std::ceil(height / side), 1.0, cell_count));
+        layout_.columns = static_cast<uint32_t>(std::clamp(std::ceil(width / side), 1.0, cell_count));
+        // Just past the maximum, so points on it fall inside.
+        layout_.cell_height = std::max(max.lat - min.lat, geo::EPSILON) * (1 + 1e-9) / layout_.rows;
+        layout_.cell_width = std::max(max.lng - min.lng, geo::EPSILON) * (1 + 1e-9) / layout_.columns;
+
+        std::vector<uint32_t> cells(points.size());
+        cell_offsets_.assign(static_cast<size_t>(layout_.rows) * layout_.columns + 1, 0);
+        for (size_t i = 0; i < points.size(); ++i) {
+            cells[i] = GetRow(points[i].coordinates.lat) * layout_.columns + GetColumn(points[i].coordinates.lng);
+            ++cell_offsets_[cells[i] + 1];
+        }
+        for (size_t cell = 1; cell < cell_offsets_.size(); ++cell) {
+            cell_offsets_[cell] += cell_offsets_[cell - 1];
+        }
+        std::vector<uint32_t> next_slots(cell_offsets_.begin(), cell_offsets_.end() - 1);
+        points_.resize(points.size());
+        for (size_t i = 0; i < points.size(); ++i) {
+            points_[next_slots[cells[i]]++] = points[i];
+        }
+    }
+
+    inline GridIndex::GridIndex(GridLayout layout, std::vector<uint32_t> cell_offsets, std::vector<Point> points)
+            : layout_(layout)
+            , cell_offsets_(std::move(cell_offsets))
+            , points_(std::move(points))
+    {
+        if (cell_offsets_.size() != static_cast<size_t>(layout_.rows) * layout_.columns + 1
+            || cell_offsets_.back() != points_.size() || layout_.cell_height <= 0.0 || layout_.cell_width <= 0.0) {
+            throw std::invalid_argument("Grid index parts don't match each other");
+        }
+    }
+
+    inline std::vector<Neighbour> GridIndex::FindWithinRadius(geo::Coordinates center, double radius) const {
+        std::vector<Neighbour> result;
+        if (points_.empty() || radius < 0.0) return result;
+
+        constexpr double DEGREES_PER_RADIAN = 180 / M_PI;
+        const double angle = (radius + BOX_MARGIN) / EARTH_RADIUS;
+        const double min_lat = center.lat - angle * DEGREES_PER_RADIAN;
+        const double max_lat = center.lat + angle * DEGREES_PER_RADIAN;
+        // The circle spans asin(sin(angle) / cos(lat)) of longitude unless it reaches a pole.
+        const double center_lat = center.lat / DEGREES_PER_RADIAN;
+        if (angle >= M_PI / 2 - std::abs(center_lat)) {
+            CollectBox(center, radius, min_lat, max_lat, -180.0, 180.0, result);
+        } else {
+            const double lng_span = std::asin(std::min(1.0, std::sin(angle) / std::cos(center_lat))) * DEGREES_PER_RADIAN;
+            CollectBox(center, radius, min_lat, max_lat, center.lng - lng_span, center.lng + lng_span, result);
+            // A circle across the antimeridian continues on the other side of it.
+            if (center.lng - lng_span < -180.0) {
+                CollectBox(center, radius, min_lat, max_lat, center.lng - lng_span + 360.0, 180.0, result);
+            }
+            if (center.lng + lng_span > 180.0) {
+                CollectBox(center, radius, min_lat, max_lat, -180.0, center.lng + lng_span - 360.0, result);
+            }
+        }
+        std::sort(result.begin(), result.end(), [](const Neighbour& lhs, const Neighbour& rhs) {
+            return lhs.distance < rhs.distance || (lhs.distance == rhs.distance && lhs.id < rhs.id);
+        });
+        result.erase(std::unique(result.begin(), result.end(), [](const Neighbour& lhs, const Neighbour& rhs) {
+            return lhs.id == rhs.id;
+        }), result.end());
+        return result;
+    }
+
+    // Doubles the radius from about one cell until it holds count points.
+    inline std::vector<Neighbour> GridIndex::FindNearest(geo::Coordinates center, size_t count, double max_radius) const {
+        if (points_.empty() || count == 0) return {};
+        const double max_distance = std::min(max_radius, M_PI * EARTH_RADIUS);
+        double radius = std::min(max_distance, std::max(layout_.cell_height, layout_.cell_width) * M_PI / 180 * EARTH_RADIUS);
+        std::vector<Neighbour> result = FindWithinRadius(center, radius);
+        while (result.size() < count && radius < max_distance) {
+            radius = std::min(max_distance, radius * 2);
+            result = FindWithinRadius(center, radius);
+        }
+        if (result.size() > count) {
+            result.resize(count);
+        }
+        return result;
+    }
+
+    inline const GridLayout& GridIndex::GetLayout() const & {
+        return layout_;
+    }
+
+    inline const std::vector<uint32_t>& GridIndex::GetCellOffsets() const & {
+        return cell_offsets_;
+    }
+
+    inline const std::vector<Point>& GridIndex::GetPoints() const & {
+        return points_;
+    }
+
+    inline uint32_t GridIndex::GetRow(double lat) const {
+        const double row = std::floor((lat - layout_.min.lat) / layout_.cell_height);
+        return static_cast<uint32_t>(std::clamp(row, 0.0, layout_.rows - 1.0));
+    }
+
+    inline uint32_t GridIndex::GetColumn(double lng) const {
+        const double column = std::floor((lng - layout_.min.lng) / layout_.cell_width);
+        return static_cast<uint32_t>(std::clamp(column, 0.0, layout_.columns - 1.0));
+    }
+
+    inline void GridIndex::CollectBox(geo::Coordinates center, double radius, double min_lat, double max_lat,
+                                      double min_lng, double max_lng, std::vector<Neighbour>& result) const {
+        const double grid_max_lat = layout_.min.lat + layout_.cell_height * layout_.rows;
+        const double grid_max_lng = layout_.min.lng + layout_.cell_width * layout_.columns;
+        if (max_lat < layout_.min.lat || min_lat > grid_max_lat || max_lng < layout_.min.lng || min_lng > grid_max_lng) {
+            return;
+        }
+        const uint32_t first_row = GetRow(min_lat);
+        const uint32_t last_row = GetRow(max_lat);
+        const uint32_t first_column = GetColumn(min_lng);
+        const uint32_t last_column = GetColumn(max_lng);
+        for (uint32_t row = first_row; row <= last_row; ++row) {
+            const size_t first_cell = static_cast<size_t>(row) * layout_.columns + first_column;
+            const size_t last_cell = static_cast<size_t>(row) * layout_.columns + last_column;
+            for (uint32_t i = cell_offsets_[first_cell]; i < cell_offsets_[last_cell + 1]; ++i) {
+                double distance = geo::ComputeDistance(center, points_[i].coordinates);
+                // acos of a value rounded just above one, for points a hair apart.
+                if (std::isnan(distance)) {
+                    distance = 0.0;
+                }
+                if (distance <= radius) {
+                    result.push_back({points_[i].id, distance});
+                }
+            }
+        }
+    }
+}  // namespace spatial
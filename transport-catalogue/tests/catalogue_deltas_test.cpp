@@ -0,0 +1,193 @@
+#include "transport_catalogue.h"
+#include "transport_router.h"
+#include "testing.h"
+
+#include <cmath>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+    using transport_router::EngineType;
+    using transport_router::GraphModel;
+    using transport_router::WeightType;
+
+    constexpr size_t STOP_COUNT = 30;
+    constexpr size_t BUS_COUNT = 10;
+
+    std::string GetStopName(size_t stop) {
+        return "Stop " + std::to_string(stop);
+    }
+
+    // Random buses over random stops, every ride has a road distance a bit longer than the straight line.
+    void FillCatalogue(transport_catalogue::TransportCatalogue& transport_catalogue) {
+        std::mt19937 generator(3);
+        std::uniform_real_distribution<double> offset(0.0, 0.05);
+        for (size_t stop = 0; stop < STOP_COUNT; ++stop) {
+            transport_catalogue.AddStop({GetStopName(stop), 55.6 + offset(generator), 37.5 + offset(generator)});
+        }
+        std::uniform_int_distribution<size_t> stop_index(0, STOP_COUNT - 1);
+        for (size_t bus = 0; bus < BUS_COUNT; ++bus) {
+            domain::RawBus raw_bus{"Bus " + std::to_string(bus), {},
+                                   bus % 2 == 0 ? domain::BusType::REVERSE : domain::BusType::CIRCULAR};
+            for (size_t i = 0; i < 6; ++i) {
+                raw_bus.stops_.push_back(GetStopName(stop_index(generator)));
+            }
+            if (raw_bus.type_ == domain::BusType::CIRCULAR) {
+                raw_bus.stops_.push_back(raw_bus.stops_.front());
+            }
+            for (size_t i = 0; i + 1 < raw_bus.stops_.size(); ++i) {
+                const domain::Stop* from = transport_catalogue.FindStop(raw_bus.stops_[i]);
+                const domain::Stop* to = transport_catalogue.FindStop(raw_bus.stops_[i + 1]);
+                const double distance = geo::ComputeDistance({from->latitude_, from->longitude_}, {to->latitude_, to->longitude_});
+                transport_catalogue.AddStopsDistancesByPair(from->name_, to->name_, static_cast<int>(distance * 1.3) + 1);
+            }
+            transport_catalogue.AddBus(raw_bus);
+        }
+    }
+
+    // A bus whose stops are all served by other buses too, so removing it keeps every stop used, or the other way.
+    std::string FindBus(const transport_catalogue::TransportCatalogue& transport_catalogue, bool keeps_stops_used) {
+        for (const domain::Bus& bus : transport_catalogue.GetBuses()) {
+            bool stops_shared = true;
+            for (const domain::Stop* stop : bus.stops_) {
+                stops_shared = stops_shared && transport_catalogue.GetStopInfo(*stop).buses_.size() > 1;
+            }
+            if (!bus.stops_.empty() && stops_shared == keeps_stops_used) {
+                return std::string(bus.name_);
+            }
+        }
+        return {};
+    }
+
+    std::vector<transport_catalogue::CatalogueDeltas> MakeDeltas(const transport_catalogue::TransportCatalogue& transport_catalogue) {
+        const domain::Bus& bus = transport_catalogue.GetBuses().front();
+        const std::string first(bus.stops_[0]->name_);
+        const std::string second(bus.stops_[1]->name_);
+        const std::string third(bus.stops_[2]->name_);
+        const int distance = transport_catalogue.GetDistancesBetweenStops(bus.stops_[0], bus.stops_[1]);
+
+        transport_catalogue::CatalogueDeltas reweighted;
+        reweighted.changed_distances_ = {{first, second, distance / 2}, {second, third, distance * 3}};
+
+        transport_catalogue::CatalogueDeltas added;
+        added.added_buses_.push_back({"New bus", {GetStopName(0), GetStopName(1), GetStopName(2)}, domain::BusType::REVERSE});
+        added.changed_distances_ = {{GetStopName(0), GetStopName(1), 700}, {GetStopName(1), GetStopName(2), 900}};
+
+        transport_catalogue::CatalogueDeltas removed;
+        removed.removed_buses_.push_back(FindBus(transport_catalogue, true));
+
+        transport_catalogue::CatalogueDeltas removed_with_stops;
+        removed_with_stops.removed_buses_.push_back(FindBus(transport_catalogue, false));
+
+        transport_catalogue::CatalogueDeltas replaced;
+        replaced.removed_buses_.push_back(std::string(bus.name_));
+        replaced.added_buses_.push_back({std::string(bus.name_), {first, third}, domain::BusType::CIRCULAR});
+        replaced.changed_distances_ = {{first, third, 400}, {third, first, 500}};
+
+        return {reweighted, added, removed, removed_with_stops, replaced};
+    }
+
+    double GetTotalTime(const transport_router::RouteDescription& route) {
+        double time = 0.0;
+        for (const transport_router::EdgeDescription& edge : *route) {
+            time += edge.time_;
+        }
+        return time;
+    }
+
+    bool AreClose(double lhs, double rhs, double tolerance) {
+        return std::abs(lhs - rhs) <= tolerance * std::max(1.0, std::abs(rhs));
+    }
+
+    std::map<std::string_view, double> MakeTimesByStop(const transport_router::Isochrone& isochrone) {
+        std::map<std::string_view, double> times;
+        for (const transport_router::ReachableStop& stop : isochrone) {
+            times.emplace(stop.stop_name_, stop.time_);
+        }
+        return times;
+    }
+
+    // Route, Matrix and Isochrone answers of the updated router have to match those of a router built anew.
+    // Routes equally fast in a compact matrix may differ in their exact time by up to route_tolerance minutes.
+    void CheckSameAnswers(const transport_router::TransportRouter& updated, const transport_router::TransportRouter& rebuilt,
+                          const std::vector<std::string_view>& stop_names, double tolerance, double route_tolerance) {
+        for (std::string_view from : stop_names) {
+            for (std::string_view to : stop_names) {
+                const transport_router::RouteDescription updated_route = updated.BuildRoute(from, to);
+                const transport_router::RouteDescription rebuilt_route = rebuilt.BuildRoute(from, to);
+                CHECK((updated_route == nullptr) == (rebuilt_route == nullptr));
+                if (updated_route != nullptr && rebuilt_route != nullptr) {
+                    CHECK(std::abs(GetTotalTime(updated_route) - GetTotalTime(rebuilt_route)) <= route_tolerance);
+                }
+            }
+        }
+
+        const transport_router::TimeMatrix updated_matrix = updated.BuildTimeMatrix(stop_names, stop_names);
+        const transport_router::TimeMatrix rebuilt_matrix = rebuilt.BuildTimeMatrix(stop_names, stop_names);
+        CHECK(updated_matrix.size() == rebuilt_matrix.size());
+        for (size_t row = 0; row < std::min(updated_matrix.size(), rebuilt_matrix.size()); ++row) {
+            CHECK(updated_matrix[row].size() == rebuilt_matrix[row].size());
+            for (size_t column = 0; column < std::min(updated_matrix[row].size(), rebuilt_matrix[row].size()); ++column) {
+                const auto& updated_time = updated_matrix[row][column];
+                const auto& rebuilt_time = rebuilt_matrix[row][column];
+                CHECK(updated_time.has_value() == rebuilt_time.has_value());
+                if (updated_time && rebuilt_time) {
+                    CHECK(AreClose(*updated_time, *rebuilt_time, tolerance));
+                }
+            }
+        }
+
+        for (std::string_view from : stop_names) {
+            const auto updated_isochrone = updated.BuildIsochrone(from, 30.0);
+            const auto rebuilt_isochrone = rebuilt.BuildIsochrone(from, 30.0);
+            CHECK(updated_isochrone.has_value() && rebuilt_isochrone.has_value());
+            if (!updated_isochrone || !rebuilt_isochrone) continue;
+            const auto updated_times = MakeTimesByStop(*updated_isochrone);
+            const auto rebuilt_times = MakeTimesByStop(*rebuilt_isochrone);
+            CHECK(updated_times.size() == rebuilt_times.size());
+            for (const auto& [stop_name, time] : rebuilt_times) {
+                auto it = updated_times.find(stop_name);
+                CHECK(it != updated_times.end() && AreClose(it->second, time, tolerance));
+            }
+        }
+    }
+
+    void CheckDeltas(EngineType engine, GraphModel graph_model, WeightType weight_type,
+                     double tolerance, double route_tolerance) {
+        transport_router::RoutingSettings settings;
+        settings.bus_wait_time_ = 2.0;
+        settings.bus_velocity_ = 40.0;
+        settings.engine_ = engine;
+        settings.graph_model_ = graph_model;
+        settings.weight_type_ = weight_type;
+        settings.landmark_count_ = 4;
+
+        transport_catalogue::TransportCatalogue base_catalogue;
+        FillCatalogue(base_catalogue);
+        for (const transport_catalogue::CatalogueDeltas& deltas : MakeDeltas(base_catalogue)) {
+            transport_catalogue::TransportCatalogue transport_catalogue;
+            FillCatalogue(transport_catalogue);
+            transport_router::TransportRouter updated(settings, transport_catalogue);
+            transport_catalogue.ApplyDeltas(deltas);
+            updated.ApplyCatalogueDeltas(deltas);
+            const transport_router::TransportRouter rebuilt(settings, transport_catalogue);
+            CheckSameAnswers(updated, rebuilt, transport_catalogue.GetUsedStopNames(), tolerance, route_tolerance);
+        }
+    }
+}  // namespace
+
+int main() {
+    for (GraphModel graph_model : {GraphModel::COMPLETE, GraphModel::TRIP_BASED}) {
+        for (EngineType engine : {EngineType::ALL_PAIRS, EngineType::DIJKSTRA, EngineType::CONTRACTION_HIERARCHIES,
+                                  EngineType::HUB_LABELS, EngineType::ALT, EngineType::RAPTOR}) {
+            CheckDeltas(engine, graph_model, WeightType::DOUBLE, 1e-9, 1e-7);
+        }
+        CheckDeltas(EngineType::ALL_PAIRS, graph_model, WeightType::FLOAT, 1e-5, 1e-3);
+        CheckDeltas(EngineType::ALL_PAIRS, graph_model, WeightType::FIXED_POINT, 1e-9, 0.01);
+    }
+    return testing::Finish();
+}
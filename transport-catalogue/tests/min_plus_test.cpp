@@ -0,0 +1,84 @@
+#include "min_plus.h"
+#include "testing.h"
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+    constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+    template <typename MatrixWeight>
+    struct Row {
+        std::vector<MatrixWeight> weights;
+        std::vector<uint32_t> prev_edges;
+    };
+
+    // Small values, so candidates often tie with the current cells, and some unreachable cells.
+    template <typename MatrixWeight>
+    Row<MatrixWeight> MakeRow(std::mt19937& generator, size_t count, MatrixWeight unreachable) {
+        std::uniform_int_distribution<int> value(0, 20);
+        Row<MatrixWeight> row;
+        for (size_t i = 0; i < count; ++i) {
+            const int weight = value(generator);
+            row.weights.push_back(weight == 0 ? unreachable : static_cast<MatrixWeight>(weight));
+            row.prev_edges.push_back(value(generator) < 4 ? NO_EDGE : static_cast<uint32_t>(value(generator)));
+        }
+        return row;
+    }
+
+    template <typename MatrixWeight>
+    void CheckKernel(min_plus::InstructionSet instruction_set, MatrixWeight unreachable) {
+        std::mt19937 generator(42);
+        std::vector<size_t> counts;
+        for (size_t count = 0; count <= 40; ++count) {
+            counts.push_back(count);
+        }
+        counts.push_back(1003);
+        for (size_t count : counts) {
+            for (int attempt = 0; attempt < 20; ++attempt) {
+                const Row<MatrixWeight> through = MakeRow(generator, count, unreachable);
+                Row<MatrixWeight> expected = MakeRow(generator, count, unreachable);
+                Row<MatrixWeight> actual = expected;
+                const MatrixWeight weight_from = attempt == 0 ? unreachable : static_cast<MatrixWeight>(attempt % 7);
+                const uint32_t prev_edge_from = 1000 + attempt;
+                min_plus::RelaxRow(min_plus::InstructionSet::SCALAR, through.weights.data(), through.prev_edges.data(),
+                                   expected.weights.data(), expected.prev_edges.data(), count, weight_from,
+                                   prev_edge_from, NO_EDGE);
+                min_plus::RelaxRow(instruction_set, through.weights.data(), through.prev_edges.data(),
+                                   actual.weights.data(), actual.prev_edges.data(), count, weight_from,
+                                   prev_edge_from, NO_EDGE);
+                CHECK(actual.weights == expected.weights);
+                CHECK(actual.prev_edges == expected.prev_edges);
+            }
+        }
+    }
+
+    // The scalar kernel itself against the definition of a relaxation.
+    void CheckScalarKernel() {
+        const std::vector<float> through{1.0f, std::numeric_limits<float>::infinity(), 2.0f, 0.0f};
+        const std::vector<uint32_t> prev_through{7, 8, NO_EDGE, NO_EDGE};
+        std::vector<float> row{5.0f, 1.0f, 4.0f, std::numeric_limits<float>::infinity()};
+        std::vector<uint32_t> prev_row{1, 2, 3, NO_EDGE};
+        min_plus::RelaxRow(min_plus::InstructionSet::SCALAR, through.data(), prev_through.data(), row.data(),
+                           prev_row.data(), row.size(), 2.0f, 9, NO_EDGE);
+        CHECK((row == std::vector<float>{3.0f, 1.0f, 4.0f, 2.0f}));
+        CHECK((prev_row == std::vector<uint32_t>{7, 2, 3, 9}));
+    }
+}  // namespace
+
+int main() {
+    CheckScalarKernel();
+    const min_plus::InstructionSet supported = min_plus::GetInstructionSet();
+    for (min_plus::InstructionSet instruction_set : {min_plus::InstructionSet::SSE41, min_plus::InstructionSet::AVX2}) {
+        if (instruction_set > supported) {
+            std::cerr << "skipped a kernel the CPU doesn't support" << std::endl;
+            continue;
+        }
+        CheckKernel<float>(instruction_set, std::numeric_limits<float>::infinity());
+        CheckKernel<uint32_t>(instruction_set, std::numeric_limits<int32_t>::max());
+    }
+    return testing::Finish();
+}
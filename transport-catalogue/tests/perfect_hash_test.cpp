@@ -0,0 +1,139 @@
+#include "perfect_hash.h"
+#include "testing.h"
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+    using perfect_hash::NameIndex;
+
+    // Names of one to twenty characters, so both the eight-byte words and the tail of the hash are used.
+    std::vector<std::string> MakeNames(std::mt19937& generator, size_t count) {
+        std::uniform_int_distribution<size_t> length(1, 20);
+        std::uniform_int_distribution<int> letter('a', 'z');
+        std::vector<std::string> names;
+        while (names.size() < count) {
+            std::string name(length(generator), ' ');
+            for (char& c : name) {
+                c = static_cast<char>(letter(generator));
+            }
+            names.push_back(name + std::to_string(names.size()));
+        }
+        return names;
+    }
+
+    std::vector<uint32_t> MakeIds(size_t count) {
+        std::vector<uint32_t> ids;
+        for (size_t i = 0; i < count; ++i) {
+            ids.push_back(static_cast<uint32_t>(i * 7 + 3));
+        }
+        return ids;
+    }
+
+    std::vector<std::string_view> MakeViews(const std::vector<std::string>& names) {
+        return {names.begin(), names.end()};
+    }
+
+    void CheckEmpty() {
+        const NameIndex default_index;
+        CHECK(default_index.GetSize() == 0);
+        CHECK(default_index.Find("") == NameIndex::NOT_FOUND);
+        CHECK(default_index.Find("stop") == NameIndex::NOT_FOUND);
+
+        const NameIndex index({}, {});
+        CHECK(index.GetSize() == 0);
+        CHECK(index.GetSeeds().empty());
+        CHECK(index.Find("stop") == NameIndex::NOT_FOUND);
+    }
+
+    void CheckSingleName() {
+        const NameIndex index({"Stop"}, {42});
+        CHECK(index.GetSize() == 1);
+        CHECK(index.Find("Stop") == 42);
+        // The only slot is occupied, so every other name lands on it and has to be told apart by comparison.
+        CHECK(index.Find("") == NameIndex::NOT_FOUND);
+        CHECK(index.Find("Sto") == NameIndex::NOT_FOUND);
+        CHECK(index.Find("Stops") == NameIndex::NOT_FOUND);
+        CHECK(index.Find("stop") == NameIndex::NOT_FOUND);
+    }
+
+    void CheckInvalidNames() {
+        bool thrown = false;
+        try {
+            NameIndex index({"A", "B", "A"}, {0, 1, 2});
+        } catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        CHECK(thrown);
+
+        thrown = false;
+        try {
+            NameIndex index({"A", "B"}, {0});
+        } catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+
+    // Every slot of a minimal perfect hash holds a name, so an absent name always probes an occupied slot.
+    void CheckLookups() {
+        std::mt19937 generator(17);
+        for (size_t count : {2, 5, 100, 5000}) {
+            const std::vector<std::string> names = MakeNames(generator, count);
+            const std::vector<uint32_t> ids = MakeIds(count);
+            const NameIndex index(MakeViews(names), ids);
+            CHECK(index.GetSize() == count);
+            for (size_t i = 0; i < count; ++i) {
+                CHECK(index.Find(names[i]) == ids[i]);
+                CHECK(index.Find(names[i] + "x") == NameIndex::NOT_FOUND);
+                CHECK(index.Find(std::string_view(names[i]).substr(1)) == NameIndex::NOT_FOUND);
+            }
+            for (const std::string& absent_name : MakeNames(generator, 1000)) {
+                CHECK(index.Find("absent " + absent_name) == NameIndex::NOT_FOUND);
+            }
+        }
+    }
+
+    // A base stores the seeds and the ids in slot order, the names are taken from the catalogue by id.
+    void CheckRestoredIndex() {
+        std::mt19937 generator(23);
+        const std::vector<std::string> names = MakeNames(generator, 300);
+        const std::vector<uint32_t> ids = MakeIds(names.size());
+        const NameIndex index(MakeViews(names), ids);
+
+        std::vector<std::string_view> slot_names;
+        for (uint32_t id : index.GetSlotIds()) {
+            slot_names.push_back(names[(id - 3) / 7]);
+        }
+        const NameIndex restored(index.GetSeeds(), slot_names, index.GetSlotIds());
+        CHECK(restored.GetSize() == index.GetSize());
+        CHECK(restored.GetSeeds() == index.GetSeeds());
+        CHECK(restored.GetSlotIds() == index.GetSlotIds());
+        for (size_t i = 0; i < names.size(); ++i) {
+            CHECK(restored.Find(names[i]) == ids[i]);
+        }
+        CHECK(restored.Find("absent") == NameIndex::NOT_FOUND);
+
+        bool thrown = false;
+        try {
+            slot_names.pop_back();
+            NameIndex broken(index.GetSeeds(), slot_names, index.GetSlotIds());
+        } catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+}  // namespace
+
+int main() {
+    CheckEmpty();
+    CheckSingleName();
+    CheckInvalidNames();
+    CheckLookups();
+    CheckRestoredIndex();
+    return testing::Finish();
+}
@@ -0,0 +1,88 @@
+#include "router.h"
+#include "testing.h"
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+    using Graph = graph::DirectedWeightedGraph<double>;
+
+    // Sparse random graph with weights in whole hundredths of a minute when on_fixed_point_grid is set.
+    Graph MakeGraph(std::mt19937& generator, size_t vertex_count, size_t edge_count, bool on_fixed_point_grid) {
+        std::uniform_int_distribution<size_t> vertex(0, vertex_count - 1);
+        std::uniform_real_distribution<double> weight(0.01, 30.0);
+        Graph graph(vertex_count);
+        for (size_t i = 0; i < edge_count; ++i) {
+            const double edge_weight = on_fixed_point_grid ? std::round(weight(generator) * 100) / 100 : weight(generator);
+            graph.AddEdge({vertex(generator), vertex(generator), edge_weight});
+        }
+        graph.Freeze();
+        return graph;
+    }
+
+    // The edges have to lead from one vertex to the other and add up to the weight of the optimal route.
+    bool IsOptimalRoute(const Graph& graph, graph::VertexId from, graph::VertexId to,
+                        const graph::RouteInfo<double>& route, double optimal_weight, double tolerance) {
+        graph::VertexId vertex = from;
+        double weight = 0.0;
+        for (graph::EdgeId edge_id : route.edges) {
+            const graph::Edge<double>& edge = graph.GetEdge(edge_id);
+            if (edge.from != vertex) return false;
+            vertex = edge.to;
+            weight += edge.weight;
+        }
+        return vertex == to && std::abs(weight - optimal_weight) <= tolerance;
+    }
+
+    // Every route of the compact router is found where the double one finds it, is optimal in double weights,
+    // and its time differs by no more than the tolerance, which may grow with the number of edges.
+    template <typename MatrixWeight, typename Tolerance>
+    void CheckRouter(const Graph& graph, const graph::Router<double>& exact_router, Tolerance tolerance) {
+        const graph::Router<double, MatrixWeight> router(graph);
+        for (graph::VertexId from = 0; from < graph.GetVertexCount(); ++from) {
+            for (graph::VertexId to = 0; to < graph.GetVertexCount(); ++to) {
+                const auto exact_route = exact_router.BuildRoute(from, to);
+                const auto route = router.BuildRoute(from, to);
+                CHECK(exact_route.has_value() == route.has_value());
+                if (!exact_route || !route) continue;
+                const double allowed = tolerance(*exact_route, *route);
+                CHECK(std::abs(route->weight - exact_route->weight) <= allowed);
+                CHECK(IsOptimalRoute(graph, from, to, *route, exact_route->weight, allowed));
+            }
+        }
+    }
+
+    double FloatTolerance(const graph::RouteInfo<double>& exact_route, const graph::RouteInfo<double>&) {
+        return exact_route.weight * 1e-5;
+    }
+
+    // Fixed point keeps hundredths of a minute.
+    double GridFixedPointTolerance(const graph::RouteInfo<double>&, const graph::RouteInfo<double>&) {
+        return 0.01;
+    }
+
+    // Off the grid, every edge is rounded by at most half of a hundredth.
+    double FixedPointTolerance(const graph::RouteInfo<double>& exact_route, const graph::RouteInfo<double>& route) {
+        return 0.005 * static_cast<double>(exact_route.edges.size() + route.edges.size());
+    }
+}  // namespace
+
+int main() {
+    std::mt19937 generator(7);
+    for (size_t vertex_count : {1, 2, 7, 33, 120}) {
+        for (bool on_fixed_point_grid : {true, false}) {
+            const Graph graph = MakeGraph(generator, vertex_count, vertex_count * 3, on_fixed_point_grid);
+            const graph::Router<double> exact_router(graph);
+            CheckRouter<float>(graph, exact_router, FloatTolerance);
+            if (on_fixed_point_grid) {
+                CheckRouter<uint32_t>(graph, exact_router, GridFixedPointTolerance);
+            } else {
+                CheckRouter<uint32_t>(graph, exact_router, FixedPointTolerance);
+            }
+        }
+    }
+    return testing::Finish();
+}
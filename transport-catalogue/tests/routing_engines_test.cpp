@@ -0,0 +1,159 @@
+#include "router.h"
+#include "dijkstra_router.h"
+#include "contraction_hierarchies.h"
+#include "hub_labels.h"
+#include "alt_router.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+#include "testing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+    using Graph = graph::DirectedWeightedGraph<double>;
+    using transport_router::EngineType;
+    using transport_router::GraphModel;
+
+    Graph MakeGraph(std::mt19937& generator, size_t vertex_count, size_t edge_count) {
+        std::uniform_int_distribution<size_t> vertex(0, vertex_count - 1);
+        std::uniform_real_distribution<double> weight(0.01, 30.0);
+        Graph graph(vertex_count);
+        for (size_t i = 0; i < edge_count; ++i) {
+            graph.AddEdge({vertex(generator), vertex(generator), weight(generator)});
+        }
+        graph.Freeze();
+        return graph;
+    }
+
+    bool AreClose(double lhs, double rhs) {
+        return std::abs(lhs - rhs) <= 1e-9 * std::max(1.0, std::abs(rhs));
+    }
+
+    // The edges have to lead from one vertex to the other and add up to the weight of the optimal route.
+    bool IsOptimalRoute(const Graph& graph, graph::VertexId from, graph::VertexId to,
+                        const graph::RouteInfo<double>& route, double optimal_weight) {
+        graph::VertexId vertex = from;
+        double weight = 0.0;
+        for (graph::EdgeId edge_id : route.edges) {
+            const graph::Edge<double>& edge = graph.GetEdge(edge_id);
+            if (edge.from != vertex) return false;
+            vertex = edge.to;
+            weight += edge.weight;
+        }
+        return vertex == to && AreClose(route.weight, optimal_weight) && AreClose(weight, optimal_weight);
+    }
+
+    // Every route of the engine is found where the all-pairs router finds it and is as short.
+    template <typename Engine>
+    void CheckEngine(const Graph& graph, const graph::Router<double>& exact_router, const Engine& engine) {
+        for (graph::VertexId from = 0; from < graph.GetVertexCount(); ++from) {
+            for (graph::VertexId to = 0; to < graph.GetVertexCount(); ++to) {
+                const auto exact_route = exact_router.BuildRoute(from, to);
+                const auto route = engine.BuildRoute(from, to);
+                CHECK(exact_route.has_value() == route.has_value());
+                if (exact_route && route) {
+                    CHECK(IsOptimalRoute(graph, from, to, *route, exact_route->weight));
+                }
+            }
+        }
+    }
+
+    void CheckGraphEngines() {
+        std::mt19937 generator(11);
+        for (size_t vertex_count : {1, 2, 7, 33, 120}) {
+            for (size_t edges_per_vertex : {1, 3, 8}) {
+                const Graph graph = MakeGraph(generator, vertex_count, vertex_count * edges_per_vertex);
+                const graph::Router<double> exact_router(graph);
+                CheckEngine(graph, exact_router, graph::DijkstraRouter<double>(graph));
+                CheckEngine(graph, exact_router, graph::ContractionHierarchiesRouter<double>(graph));
+                CheckEngine(graph, exact_router, graph::HubLabelsRouter<double>(graph));
+                CheckEngine(graph, exact_router, graph::AltRouter<double>(graph, 4));
+            }
+        }
+    }
+
+    std::string GetStopName(size_t stop) {
+        return "Stop " + std::to_string(stop);
+    }
+
+    // Random buses over random stops, every ride has a road distance a bit longer than the straight line.
+    void FillCatalogue(transport_catalogue::TransportCatalogue& transport_catalogue, std::mt19937& generator,
+                       size_t stop_count, size_t bus_count) {
+        std::uniform_real_distribution<double> offset(0.0, 0.05);
+        for (size_t stop = 0; stop < stop_count; ++stop) {
+            transport_catalogue.AddStop({GetStopName(stop), 55.6 + offset(generator), 37.5 + offset(generator)});
+        }
+        std::uniform_int_distribution<size_t> stop_index(0, stop_count - 1);
+        std::uniform_int_distribution<size_t> bus_length(2, 7);
+        for (size_t bus = 0; bus < bus_count; ++bus) {
+            domain::RawBus raw_bus{"Bus " + std::to_string(bus), {},
+                                   bus % 2 == 0 ? domain::BusType::REVERSE : domain::BusType::CIRCULAR};
+            for (size_t i = bus_length(generator); i > 0; --i) {
+                raw_bus.stops_.push_back(GetStopName(stop_index(generator)));
+            }
+            if (raw_bus.type_ == domain::BusType::CIRCULAR) {
+                raw_bus.stops_.push_back(raw_bus.stops_.front());
+            }
+            for (size_t i = 0; i + 1 < raw_bus.stops_.size(); ++i) {
+                const domain::Stop* from = transport_catalogue.FindStop(raw_bus.stops_[i]);
+                const domain::Stop* to = transport_catalogue.FindStop(raw_bus.stops_[i + 1]);
+                const double distance = geo::ComputeDistance({from->latitude_, from->longitude_}, {to->latitude_, to->longitude_});
+                transport_catalogue.AddStopsDistancesByPair(from->name_, to->name_, static_cast<int>(distance * 1.3) + 1);
+            }
+            transport_catalogue.AddBus(raw_bus);
+        }
+    }
+
+    double GetTotalTime(const transport_router::RouteDescription& route) {
+        double time = 0.0;
+        for (const transport_router::EdgeDescription& edge : *route) {
+            time += edge.time_;
+        }
+        return time;
+    }
+
+    // Every engine answers a Route request as fast as the all-pairs router over the same routing graph.
+    void CheckTransportEngines() {
+        std::mt19937 generator(5);
+        for (size_t stop_count : {2, 12, 40}) {
+            transport_catalogue::TransportCatalogue transport_catalogue;
+            FillCatalogue(transport_catalogue, generator, stop_count, stop_count / 2 + 1);
+            const std::vector<std::string_view> stop_names = transport_catalogue.GetUsedStopNames();
+            for (GraphModel graph_model : {GraphModel::COMPLETE, GraphModel::TRIP_BASED}) {
+                transport_router::RoutingSettings settings;
+                settings.bus_wait_time_ = 3.0;
+                settings.bus_velocity_ = 35.0;
+                settings.graph_model_ = graph_model;
+                settings.landmark_count_ = 4;
+                const transport_router::TransportRouter exact_router(settings, transport_catalogue);
+                for (EngineType engine : {EngineType::DIJKSTRA, EngineType::CONTRACTION_HIERARCHIES, EngineType::HUB_LABELS,
+                                          EngineType::ALT, EngineType::RAPTOR, EngineType::AUTO}) {
+                    settings.engine_ = engine;
+                    const transport_router::TransportRouter router(settings, transport_catalogue);
+                    for (std::string_view from : stop_names) {
+                        for (std::string_view to : stop_names) {
+                            const transport_router::RouteDescription exact_route = exact_router.BuildRoute(from, to);
+                            const transport_router::RouteDescription route = router.BuildRoute(from, to);
+                            CHECK((exact_route == nullptr) == (route == nullptr));
+                            if (exact_route != nullptr && route != nullptr) {
+                                CHECK(AreClose(GetTotalTime(route), GetTotalTime(exact_route)));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}  // namespace
+
+int main() {
+    CheckGraphEngines();
+    CheckTransportEngines();
+    return testing::Finish();
+}
@@ -0,0 +1,142 @@
+#include "spatial_index.h"
+#include "testing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+    using spatial::GridIndex;
+    using spatial::Neighbour;
+    using spatial::Point;
+
+    double ComputeClampedDistance(geo::Coordinates from, geo::Coordinates to) {
+        const double distance = geo::ComputeDistance(from, to);
+        return std::isnan(distance) ? 0.0 : distance;
+    }
+
+    std::vector<Neighbour> FindWithinRadius(const std::vector<Point>& points, geo::Coordinates center, double radius) {
+        std::vector<Neighbour> result;
+        for (const Point& point : points) {
+            const double distance = ComputeClampedDistance(center, point.coordinates);
+            if (distance <= radius) {
+                result.push_back({point.id, distance});
+            }
+        }
+        std::sort(result.begin(), result.end(), [](const Neighbour& lhs, const Neighbour& rhs) {
+            return lhs.distance < rhs.distance || (lhs.distance == rhs.distance && lhs.id < rhs.id);
+        });
+        return result;
+    }
+
+    bool AreSame(const std::vector<Neighbour>& lhs, const std::vector<Neighbour>& rhs) {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](const Neighbour& l, const Neighbour& r) {
+            return l.id == r.id && l.distance == r.distance;
+        });
+    }
+
+    // Points in a latitude band and a longitude range that may cross the antimeridian, then wraps into [-180, 180].
+    // Every tenth point repeats an earlier one or lies a hair away from it.
+    std::vector<Point> MakePoints(std::mt19937& generator, size_t count, double min_lat, double max_lat,
+                                  double min_lng, double max_lng) {
+        std::uniform_real_distribution<double> lat(min_lat, max_lat);
+        std::uniform_real_distribution<double> lng(min_lng, max_lng);
+        std::uniform_real_distribution<double> hair(-2e-6, 2e-6);
+        std::vector<Point> points;
+        for (uint32_t id = 0; id < count; ++id) {
+            geo::Coordinates coordinates{lat(generator), lng(generator)};
+            if (id % 10 == 9) {
+                coordinates = points[id / 2].coordinates;
+                coordinates.lat = std::clamp(coordinates.lat + hair(generator), -90.0, 90.0);
+                coordinates.lng += hair(generator);
+            }
+            if (coordinates.lng > 180.0) coordinates.lng -= 360.0;
+            if (coordinates.lng < -180.0) coordinates.lng += 360.0;
+            points.push_back({id, coordinates});
+        }
+        return points;
+    }
+
+    // Queries at the points themselves and at random places of the same area.
+    void CheckIndex(const std::vector<Point>& points, const std::vector<geo::Coordinates>& centers) {
+        const GridIndex index(points);
+        for (const geo::Coordinates& center : centers) {
+            for (double radius : {0.0, 1.0, 50.0, 1000.0, 30000.0, 500000.0, 5000000.0, 25000000.0}) {
+                const std::vector<Neighbour> expected = FindWithinRadius(points, center, radius);
+                CHECK(AreSame(index.FindWithinRadius(center, radius), expected));
+            }
+            const std::vector<Neighbour> all = FindWithinRadius(points, center, std::numeric_limits<double>::infinity());
+            for (size_t count : {1, 2, 5, 40}) {
+                const std::vector<Neighbour> nearest(all.begin(), all.begin() + std::min(count, all.size()));
+                CHECK(AreSame(index.FindNearest(center, count), nearest));
+                for (double max_radius : {10.0, 20000.0}) {
+                    std::vector<Neighbour> expected = nearest;
+                    expected.erase(std::find_if(expected.begin(), expected.end(), [max_radius](const Neighbour& neighbour) {
+                        return neighbour.distance > max_radius;
+                    }), expected.end());
+                    CHECK(AreSame(index.FindNearest(center, count, max_radius), expected));
+                }
+            }
+        }
+    }
+
+    std::vector<geo::Coordinates> MakeCenters(std::mt19937& generator, const std::vector<Point>& points, size_t count,
+                                              double min_lat, double max_lat, double min_lng, double max_lng) {
+        std::vector<geo::Coordinates> centers;
+        for (size_t i = 0; i < count && i < points.size(); ++i) {
+            centers.push_back(points[i * 7 % points.size()].coordinates);
+        }
+        for (const Point& point : MakePoints(generator, count, min_lat, max_lat, min_lng, max_lng)) {
+            centers.push_back(point.coordinates);
+        }
+        return centers;
+    }
+
+    // geo::ComputeDistance returns NaN for some points a hair more than geo::EPSILON apart, the index takes them
+    // as coinciding.
+    void CheckNanDistances(std::mt19937& generator) {
+        std::uniform_real_distribution<double> lat(-80.0, 80.0);
+        std::uniform_real_distribution<double> lng(-180.0, 180.0);
+        std::uniform_real_distribution<double> hair(1e-6, 3e-6);
+        std::vector<Point> points;
+        while (points.size() < 40) {
+            const geo::Coordinates from{lat(generator), lng(generator)};
+            const geo::Coordinates to{from.lat, std::min(180.0, from.lng + hair(generator))};
+            if (std::isnan(geo::ComputeDistance(from, to))) {
+                points.push_back({static_cast<uint32_t>(points.size()), from});
+                points.push_back({static_cast<uint32_t>(points.size()), to});
+            }
+        }
+        std::vector<geo::Coordinates> centers;
+        for (const Point& point : points) {
+            centers.push_back(point.coordinates);
+        }
+        CheckIndex(points, centers);
+    }
+
+    void CheckArea(std::mt19937& generator, size_t point_count, double min_lat, double max_lat,
+                   double min_lng, double max_lng) {
+        const std::vector<Point> points = MakePoints(generator, point_count, min_lat, max_lat, min_lng, max_lng);
+        CheckIndex(points, MakeCenters(generator, points, 15, min_lat, max_lat, min_lng, max_lng));
+    }
+}  // namespace
+
+int main() {
+    std::mt19937 generator(29);
+    CheckIndex({}, {{55.7, 37.6}});
+    CheckIndex({{0, {55.7, 37.6}}}, {{55.7, 37.6}, {55.8, 37.7}});
+    // A city.
+    CheckArea(generator, 500, 55.5, 55.9, 37.3, 37.9);
+    // Both sides of the antimeridian.
+    CheckArea(generator, 400, -10.0, 10.0, 179.0, 181.0);
+    // Around the poles, where the circles take in every longitude.
+    CheckArea(generator, 400, 89.0, 90.0, -180.0, 180.0);
+    CheckArea(generator, 400, -90.0, -89.5, -180.0, 180.0);
+    CheckNanDistances(generator);
+    // The whole globe.
+    CheckArea(generator, 1000, -90.0, 90.0, -180.0, 180.0);
+    return testing::Finish();
+}
@@ -0,0 +1,120 @@
+#include "json_reader.h"
+#include "request_handler.h"
+#include "testing.h"
+
+#include <sstream>
+#include <string>
+
+namespace {
+
+    const std::string MAKE_BASE_JSON = R"({
+        "base_requests": [
+            {"type": "Stop", "name": "A", "latitude": 55.60, "longitude": 37.60, "road_distances": {"B": 1000}},
+            {"type": "Stop", "name": "B", "latitude": 55.61, "longitude": 37.60, "road_distances": {"C": 1000}},
+            {"type": "Stop", "name": "C", "latitude": 55.62, "longitude": 37.60, "road_distances": {"D": 1000}},
+            {"type": "Stop", "name": "D", "latitude": 55.63, "longitude": 37.60, "road_distances": {}},
+            {"type": "Bus", "name": "1", "stops": ["A", "B", "C", "D"], "is_roundtrip": false}
+        ],
+        "routing_settings": {"bus_wait_time": 2, "bus_velocity": 30, "engine": "alt", "route_cache_capacity": 10},
+        "render_settings": {
+            "width": 600, "height": 400, "padding": 50, "stop_radius": 5, "line_width": 14,
+            "bus_label_font_size": 20, "bus_label_offset": [7, 15],
+            "stop_label_font_size": 18, "stop_label_offset": [7, -3],
+            "underlayer_color": [255, 255, 255, 0.85], "underlayer_width": 3, "color_palette": ["green"]
+        },
+        "serialization_settings": {"file": "unused.db"}
+    })";
+
+    // Answers the stat requests on the base above, built in memory as make_base would build it.
+    json::Array ProcessStatRequests(const std::string& stat_requests) {
+        std::istringstream make_base_input(MAKE_BASE_JSON);
+        json::Document make_base_doc = reader::ReadJSON(make_base_input);
+        auto make_base_queries = reader::ParseMakeBaseJSON(make_base_doc);
+        transport_catalogue::TransportCatalogue transport_catalogue;
+        reader::FillTransportCatalogue(transport_catalogue, make_base_queries.stops_queries_, make_base_queries.buses_queries_);
+        transport_catalogue::FrozenTransportCatalogue frozen_transport_catalogue{transport_catalogue};
+        transport_router::TransportRouter transport_router{make_base_queries.routing_settings_, transport_catalogue};
+        RequestHandler request_handler{frozen_transport_catalogue, make_base_queries.render_settings_, transport_router};
+
+        std::istringstream process_requests_input(R"({"stat_requests": )" + stat_requests + "}");
+        json::Document process_requests_doc = reader::ReadJSON(process_requests_input);
+        auto queries = reader::ParseProcessRequestsJSON(process_requests_doc);
+        return reader::ProcessStatRequests(request_handler, queries.stat_requests_).GetRoot().AsArray();
+    }
+
+    int GetCounter(const json::Node& response, const std::string& group, const std::string& counter) {
+        return response.AsDict().at(group).AsDict().at(counter).AsInt();
+    }
+
+    // A RoutingStatistics request counts the Route requests before it and none after it.
+    void CheckStatisticsInRequestOrder() {
+        const json::Array responses = ProcessStatRequests(R"([
+            {"id": 1, "type": "Route", "from": "A", "to": "C"},
+            {"id": 2, "type": "RoutingStatistics"},
+            {"id": 3, "type": "Route", "from": "B", "to": "D"},
+            {"id": 4, "type": "Route", "from": "A", "to": "C"},
+            {"id": 5, "type": "RoutingStatistics"}
+        ])");
+        CHECK(responses.size() == 5);
+        CHECK(responses[0].AsDict().count("total_time") > 0);
+        CHECK(GetCounter(responses[1], "route_cache", "misses") == 1);
+        CHECK(GetCounter(responses[1], "route_cache", "hits") == 0);
+        CHECK(GetCounter(responses[1], "route_cache", "size") == 1);
+        CHECK(GetCounter(responses[1], "search", "queries") == 1);
+        CHECK(responses[2].AsDict().count("total_time") > 0);
+        CHECK(responses[3].AsDict().at("total_time") == responses[0].AsDict().at("total_time"));
+        CHECK(GetCounter(responses[4], "route_cache", "misses") == 2);
+        CHECK(GetCounter(responses[4], "route_cache", "hits") == 1);
+        CHECK(GetCounter(responses[4], "search", "queries") == 2);
+    }
+
+    std::string GetErrorMessage(const json::Node& response) {
+        const json::Dict& dict = response.AsDict();
+        return dict.count("error_message") > 0 ? dict.at("error_message").AsString() : std::string{};
+    }
+
+    // A malformed NearbyStops request gets its own error response, the requests around it are answered.
+    void CheckNearbyStopsErrors() {
+        const json::Array responses = ProcessStatRequests(R"([
+            {"id": 1, "type": "NearbyStops", "latitude": 55.60, "longitude": 37.60},
+            {"id": 2, "type": "NearbyStops", "latitude": 55.60, "longitude": 37.60, "radius": -1},
+            {"id": 3, "type": "NearbyStops", "latitude": 55.60, "longitude": 37.60, "count": -1},
+            {"id": 4, "type": "NearbyStops", "latitude": 55.60, "longitude": 37.60, "count": 2},
+            {"id": 5, "type": "Bus", "name": "1"}
+        ])");
+        CHECK(responses.size() == 5);
+        CHECK(GetErrorMessage(responses[0]) == "radius or count required");
+        CHECK(responses[0].AsDict().at("request_id").AsInt() == 1);
+        CHECK(GetErrorMessage(responses[1]) == "invalid radius");
+        CHECK(GetErrorMessage(responses[2]) == "invalid count");
+        const json::Array& stops = responses[3].AsDict().at("stops").AsArray();
+        CHECK(stops.size() == 2);
+        CHECK(stops[0].AsDict().at("stop_name").AsString() == "A");
+        CHECK(stops[1].AsDict().at("stop_name").AsString() == "B");
+        CHECK(responses[4].AsDict().count("route_length") > 0);
+    }
+
+    // A Route request with an invalid metric override gets its own error response.
+    void CheckRouteMetricErrors() {
+        const json::Array responses = ProcessStatRequests(R"([
+            {"id": 1, "type": "Route", "from": "A", "to": "C", "bus_velocity": 0},
+            {"id": 2, "type": "Route", "from": "A", "to": "C", "bus_velocity": -10},
+            {"id": 3, "type": "Route", "from": "A", "to": "C", "bus_wait_time": -1},
+            {"id": 4, "type": "Route", "from": "A", "to": "C", "bus_velocity": 60},
+            {"id": 5, "type": "Route", "from": "A", "to": "C"}
+        ])");
+        CHECK(responses.size() == 5);
+        for (size_t i = 0; i < 3; ++i) {
+            CHECK(GetErrorMessage(responses[i]) == "invalid bus_wait_time or bus_velocity");
+            CHECK(responses[i].AsDict().at("request_id").AsInt() == static_cast<int>(i) + 1);
+        }
+        CHECK(responses[3].AsDict().at("total_time").AsDouble() < responses[4].AsDict().at("total_time").AsDouble());
+    }
+}  // namespace
+
+int main() {
+    CheckStatisticsInRequestOrder();
+    CheckNearbyStopsErrors();
+    CheckRouteMetricErrors();
+    return testing::Finish();
+}
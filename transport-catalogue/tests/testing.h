@@ -0,0 +1,24 @@
+#pragma once
+
+#include <iostream>
+
+namespace testing {
+
+    inline int failure_count = 0;
+
+    inline int Finish() {
+        if (failure_count > 0) {
+            std::cerr << failure_count << " check(s) failed" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+}  // namespace testing
+
+#define CHECK(condition)                                                                        \
+    do {                                                                                        \
+        if (!(condition)) {                                                                     \
+            ++testing::failure_count;                                                           \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition << std::endl; \
+        }                                                                                       \
+    } while (false)
@@ -7,67 +7,157 @@ namespace transport_catalogue {
     using namespace std::string_literals;
 
     void TransportCatalogue::AddStop(domain::Stop stop) {
+        stop.id_ = static_cast<uint32_t>(stops_.size());
+        stop.name_ = InternName(stop.name_);
         stops_.push_back(std::move(stop));
-        stop_indexes_.insert({std::string_view(stops_.back().name_), &stops_.back()});
+        stop_indexes_.insert({stops_.back().name_, stops_.back().id_});
+        distances_between_stops_.emplace_back();
+        buses_through_the_stop_indexes_.emplace_back();
+        last_bus_marks_.push_back(0);
     }
 
     void TransportCatalogue::AddBus(domain::RawBus raw_bus) {
-        std::vector<const domain::Stop*> stops_set;
-        std::unordered_set<std::string_view> unique_stops;
+        const uint32_t bus_id = static_cast<uint32_t>(buses_.size());
+        std::pmr::vector<const domain::Stop*> stops_set(arena_.get());
+        stops_set.reserve(raw_bus.stops_.size());
+        size_t unique_stop_count = 0;
         for (const std::string_view str : raw_bus.stops_) {
-            stops_set.push_back(FindStop(str));
-            unique_stops.insert(str);
+            const domain::Stop* stop = FindStop(str);
+            if (stop == nullptr) {
+                throw std::out_of_range("Unknown stop of bus "s.append(raw_bus.name_).append(": ").append(str));
+            }
+            stops_set.push_back(stop);
+        }
+        for (const domain::Stop* stop : stops_set) {
+            if (last_bus_marks_[stop->id_] != bus_id + 1) {
+                last_bus_marks_[stop->id_] = bus_id + 1;
+                ++unique_stop_count;
+            }
         }
-        buses_.push_back({std::move(raw_bus.name_), std::move(stops_set), unique_stops.size(), raw_bus.type_});
-        buses_indexes_.insert({std::string_view(buses_.back().name_), &buses_.back()});
-        for (const std::string_view str : unique_stops) {
-            buses_through_the_stop_indexes_[FindStop(str)].insert(buses_.back().name_);
+
+        buses_.push_back({InternName(raw_bus.name_), std::move(stops_set), unique_stop_count, raw_bus.type_});
+        domain::Bus& bus = buses_.back();
+        bus.id_ = bus_id;
+        ComputeBusStatistics(bus);
+        buses_indexes_.insert({bus.name_, bus.id_});
+        for (const domain::Stop* stop : bus.stops_) {
+            std::pmr::vector<uint32_t>& stop_buses = buses_through_the_stop_indexes_[stop->id_];
+            auto position = std::lower_bound(stop_buses.begin(), stop_buses.end(), bus.name_,
+                                             [this](uint32_t other_bus_id, std::string_view name) {
+                return buses_[other_bus_id].name_ < name;
+            });
+            if (position != stop_buses.end() && buses_[*position].name_ == bus.name_) continue;
+            if (stop_buses.empty()) {
+                ++used_stop_count_;
+            }
+            stop_buses.insert(position, bus.id_);
         }
     }
 
     void TransportCatalogue::AddStopsDistances(const std::pair<std::string, std::unordered_map<std::string, int>>& distances) {
         for (auto& [key , value] : distances.second) {
-            distances_between_stops_.insert({{FindStop(distances.first), FindStop(key)}, value});
+            AddStopsDistancesByPair(distances.first, key, value);
         }
     }
     void TransportCatalogue::AddStopsDistancesByPair(std::string_view from, std::string_view to, int distance) {
-        distances_between_stops_.insert({{FindStop(from), FindStop(to)}, distance});
+        InsertRoadDistance(stop_indexes_.at(from), stop_indexes_.at(to), distance, false);
+    }
+
+    void TransportCatalogue::RemoveBus(std::string_view name) {
+        auto index_it = buses_indexes_.find(name);
+        if (index_it == buses_indexes_.end()) {
+            throw std::out_of_range("Unknown bus: "s.append(name));
+        }
+        domain::Bus& bus = buses_[index_it->second];
+        for (const domain::Stop* stop : bus.stops_) {
+            std::pmr::vector<uint32_t>& stop_buses = buses_through_the_stop_indexes_[stop->id_];
+            auto position = std::find(stop_buses.begin(), stop_buses.end(), bus.id_);
+            if (position == stop_buses.end()) continue;
+            stop_buses.erase(position);
+            if (stop_buses.empty()) {
+                --used_stop_count_;
+            }
+        }
+        buses_indexes_.erase(index_it);
+        bus.stops_.clear();
+        bus.unique_stops_ = 0;
+    }
+
+    void TransportCatalogue::SetStopsDistance(std::string_view from, std::string_view to, int distance) {
+        const domain::Stop* stop_from = FindStop(from);
+        const domain::Stop* stop_to = FindStop(to);
+        if (stop_from == nullptr || stop_to == nullptr) {
+            throw std::out_of_range("Unknown stop in a distance between "s.append(from).append(" and ").append(to));
+        }
+        InsertRoadDistance(stop_from->id_, stop_to->id_, distance, true);
+        // A bus between the two stops calls at stop_from either way.
+        for (uint32_t bus_id : buses_through_the_stop_indexes_[stop_from->id_]) {
+            ComputeBusStatistics(buses_[bus_id]);
+        }
+    }
+
+    void TransportCatalogue::ApplyDeltas(const CatalogueDeltas& deltas) {
+        for (const std::string& name : deltas.removed_buses_) {
+            RemoveBus(name);
+        }
+        for (const StopsDistance& distance : deltas.changed_distances_) {
+            SetStopsDistance(distance.from_, distance.to_, distance.distance_);
+        }
+        for (const domain::RawBus& raw_bus : deltas.added_buses_) {
+            for (const std::string& stop : raw_bus.stops_) {
+                if (FindStop(stop) == nullptr) {
+                    throw std::out_of_range("Unknown stop of bus "s.append(raw_bus.name_).append(": ").append(stop));
+                }
+            }
+            AddBus(raw_bus);
+        }
     }
 
     const domain::Bus* TransportCatalogue::FindBus(std::string_view name) const {
-        if (buses_indexes_.count(name) == 0) return nullptr;
-        return buses_indexes_.at(name);
+        auto it = buses_indexes_.find(name);
+        if (it == buses_indexes_.end()) return nullptr;
+        return &buses_[it->second];
     }
 
     const domain::Stop* TransportCatalogue::FindStop(std::string_view name) const {
-        if (stop_indexes_.count(name) == 0) return nullptr;
-        return stop_indexes_.at(name);
+        auto it = stop_indexes_.find(name);
+        if (it == stop_indexes_.end()) return nullptr;
+        return &stops_[it->second];
     }
 
     std::optional<domain::BusInfo> TransportCatalogue::GetBusInfo(std::string_view name) const {
-        domain::BusInfo info;
         const domain::Bus* bus = FindBus(name);
         if (bus == nullptr) return std::nullopt;
-        info.name_ = bus->name_;
-        info.unique_stops_ = static_cast<int>(bus->unique_stops_);
-        if (bus->type_ == domain::BusType::REVERSE) {
-            info.stops_on_route_ = static_cast<int>(bus->stops_.size()) * 2 - 1;
-        } else if (bus->type_ == domain::BusType::CIRCULAR) {
-            info.stops_on_route_ = static_cast<int>(bus->stops_.size());
-        }
-        info.route_length_road_ = ComputeRoadDistance(*bus);
-        info.curvature_ =  info.route_length_road_ / ComputeGeographicalDistance(*bus);
-        return info;
+        return GetBusInfo(*bus);
     }
 
     std::optional<domain::StopInfo> TransportCatalogue::GetStopInfo(std::string_view name) const {
         const domain::Stop* stop = FindStop(name);
         if (stop == nullptr) return std::nullopt;
-        if (buses_through_the_stop_indexes_.count(stop) == 0) {
-            domain::StopInfo empty{stop->name_, nullptr};
-            return empty;
+        return GetStopInfo(*stop);
+    }
+
+    domain::BusInfo TransportCatalogue::GetBusInfo(const domain::Bus& bus) const {
+        domain::BusInfo info;
+        info.name_ = bus.name_;
+        info.unique_stops_ = static_cast<int>(bus.unique_stops_);
+        if (bus.type_ == domain::BusType::REVERSE) {
+            info.stops_on_route_ = static_cast<int>(bus.stops_.size()) * 2 - 1;
+        } else if (bus.type_ == domain::BusType::CIRCULAR) {
+            info.stops_on_route_ = static_cast<int>(bus.stops_.size());
+        }
+        info.route_length_road_ = bus.route_length_;
+        info.curvature_ = bus.curvature_;
+        return info;
+    }
+
+    domain::StopInfo TransportCatalogue::GetStopInfo(const domain::Stop& stop) const {
+        domain::StopInfo info{stop.name_, {}};
+        const std::pmr::vector<uint32_t>& stop_buses = buses_through_the_stop_indexes_[stop.id_];
+        info.buses_.reserve(stop_buses.size());
+        for (uint32_t bus_id : stop_buses) {
+            info.buses_.push_back(buses_[bus_id].name_);
         }
-        domain::StopInfo info{stop->name_, &buses_through_the_stop_indexes_.at(stop)};
         return info;
     }
 
@@ -80,9 +170,9 @@ namespace transport_catalogue {
 
     std::vector<const domain::Bus*> TransportCatalogue::GetSortedBuses() const {
         std::vector<const domain::Bus*> buses;
-        for (auto [name, bus] : buses_indexes_) {
-            if (!bus->stops_.empty()) {
-                buses.push_back(bus);
+        for (const domain::Bus& bus : buses_) {
+            if (!bus.stops_.empty()) {
+                buses.push_back(&bus);
             }
         }
         std::sort(buses.begin(), buses.end(), [](const domain::Bus* lhs, const domain::Bus* rhs){
@@ -93,9 +183,10 @@ namespace transport_catalogue {
 
     std::vector<const domain::Stop*> TransportCatalogue::GetSortedStops() const {
         std::vector<const domain::Stop*> stops;
-        for (auto [stop, buses] : buses_through_the_stop_indexes_) {
-            if (!buses.empty()) {
-                stops.push_back(stop);
+        stops.reserve(used_stop_count_);
+        for (const domain::Stop& stop : stops_) {
+            if (!buses_through_the_stop_indexes_[stop.id_].empty()) {
+                stops.push_back(&stop);
             }
         }
         std::sort(stops.begin(), stops.end(), [](const domain::Stop* lhs, const domain::Stop* rhs){
@@ -106,109 +197,246 @@ namespace transport_catalogue {
 
     std::vector<geo::Coordinates> TransportCatalogue::GetValidCoordinates() const {
         std::vector<geo::Coordinates> res;
-        res.reserve(buses_through_the_stop_indexes_.size());
-        for (auto [stop, buses] : buses_through_the_stop_indexes_) {
-            if (!buses.empty()) {
-                res.push_back({stop->latitude_, stop->longitude_});
+        res.reserve(used_stop_count_);
+        for (const domain::Stop& stop : stops_) {
+            if (!buses_through_the_stop_indexes_[stop.id_].empty()) {
+                res.push_back({stop.latitude_, stop.longitude_});
             }
         }
         return res;
     }
 
-    const std::unordered_map<std::string_view, const domain::Bus*>& TransportCatalogue::GetBusIndexes() const {
-        return buses_indexes_;
+    const std::pmr::vector<RoadDistance>& TransportCatalogue::GetRoadDistances(uint32_t stop_id) const & {
+        return distances_between_stops_.at(stop_id);
     }
-    const std::unordered_map<std::pair<const domain::Stop*, const domain::Stop*>, int, Hasher>& TransportCatalogue::GetDistancess() const & {
-        return distances_between_stops_;
+
+    const std::pmr::vector<uint32_t>& TransportCatalogue::GetStopBusIds(uint32_t stop_id) const & {
+        return buses_through_the_stop_indexes_.at(stop_id);
     }
 
     size_t TransportCatalogue::GetAmountOfUsedStops() const {
-        return buses_through_the_stop_indexes_.size();
+        return used_stop_count_;
     }
 
     std::vector<std::string_view> TransportCatalogue::GetUsedStopNames() const {
         std::vector<std::string_view> used_stops_cash;
-        for (auto& buses_through_stop : buses_through_the_stop_indexes_) {
-            used_stops_cash.push_back(buses_through_stop.first->name_);
+        used_stops_cash.reserve(used_stop_count_);
+        for (const domain::Stop& stop : stops_) {
+            if (!buses_through_the_stop_indexes_[stop.id_].empty()) {
+                used_stops_cash.push_back(stop.name_);
+            }
         }
         return used_stops_cash;
     }
 
     int TransportCatalogue::GetDistancesBetweenStops(const domain::Stop* stop_1, const domain::Stop* stop_2) const {
-        if (distances_between_stops_.count({stop_1, stop_2}) > 0) {
-            return distances_between_stops_.at({stop_1, stop_2});
-        } else if (distances_between_stops_.count({stop_2, stop_1})) {
-            return distances_between_stops_.at({stop_2, stop_1});
+        if (std::optional<int> distance = FindRoadDistance(stop_1, stop_2)) {
+            return *distance;
+        }
+        std::string error_message = "No any known distance between stops: "s
+                                    .append(stop_1->name_)
+                                    .append(" and ")
+                                    .append(stop_2->name_)
+                                    .append("\n");
+        throw std::runtime_error(error_message);
+    }
+
+    std::string_view TransportCatalogue::InternName(std::string_view name) {
+        char* data = static_cast<char*>(arena_->allocate(name.size(), alignof(char)));
+        std::copy(name.begin(), name.end(), data);
+        return {data, name.size()};
+    }
+
+    void TransportCatalogue::InsertRoadDistance(uint32_t from, uint32_t to, int distance, bool overwrite) {
+        std::pmr::vector<RoadDistance>& direct = distances_between_stops_[from];
+        auto direct_it = std::find_if(direct.begin(), direct.end(), [to](const RoadDistance& item) {
+            return item.to_ == to;
+        });
+        if (direct_it == direct.end()) {
+            direct.push_back({to, distance, false});
+        } else if (direct_it->is_reverse_ || overwrite) {
+            *direct_it = {to, distance, false};
         } else {
-            std::string error_message = "No any known distance between stops: "s
-                                        .append(stop_1->name_)
-                                        .append(" and ")
-                                        .append(stop_2->name_)
-                                        .append("\n");
-            throw std::runtime_error(error_message);
+            return;
+        }
+
+        std::pmr::vector<RoadDistance>& reverse = distances_between_stops_[to];
+        auto reverse_it = std::find_if(reverse.begin(), reverse.end(), [from](const RoadDistance& item) {
+            return item.to_ == from;
+        });
+        if (reverse_it == reverse.end()) {
+            reverse.push_back({from, distance, true});
+        } else if (reverse_it->is_reverse_) {
+            reverse_it->distance_ = distance;
         }
     }
 
+    void TransportCatalogue::ComputeBusStatistics(domain::Bus& bus) const {
+        if (bus.stops_.empty()) return;
+        bus.route_length_ = ComputeRoadDistance(bus);
+        bus.curvature_ = bus.route_length_ / ComputeGeographicalDistance(bus);
+    }
+
     double TransportCatalogue::ComputeGeographicalDistance(const domain::Bus& bus) const {
-        std::vector<geo::Coordinates> coordinates;
-        std::vector<double> distances;
-        for (const domain::Stop* stop: bus.stops_) {
-            coordinates.push_back({stop->latitude_, stop->longitude_});
-        }
-        for (size_t i = 0; i < coordinates.size() - 1; i++) {
-            distances.push_back(geo::ComputeDistance(coordinates[i], coordinates[i + 1]));
+        double distance = 0.0;
+        for (size_t i = 0; i + 1 < bus.stops_.size(); i++) {
+            distance += geo::ComputeDistance({bus.stops_[i]->latitude_, bus.stops_[i]->longitude_},
+                                             {bus.stops_[i + 1]->latitude_, bus.stops_[i + 1]->longitude_});
         }
         if (bus.type_ == domain::BusType::REVERSE) {
-            return std::accumulate(distances.begin(), distances.end(), 0.0) * 2;
-        } else {
-            distances.push_back(geo::ComputeDistance(coordinates.back(), coordinates[0]));
-            return std::accumulate(distances.begin(), distances.end(), 0.0);
+            return distance * 2;
         }
+        return distance + geo::ComputeDistance({bus.stops_.back()->latitude_, bus.stops_.back()->longitude_},
+                                               {bus.stops_[0]->latitude_, bus.stops_[0]->longitude_});
     }
 
-    int TransportCatalogue::CountDistanceOnSegmentForward(const domain::Bus& bus, size_t finish) const {
-        int distance = 0;
-        for (size_t i = 0; i < finish; i++) {
-            std::pair<const domain::Stop*, const domain::Stop*> pair_of_stops(bus.stops_[i], bus.stops_[i + 1]);
-            std::pair<const domain::Stop*, const domain::Stop*> pair_of_stops_reverse(bus.stops_[i + 1], bus.stops_[i]);
-            if (distances_between_stops_.count(pair_of_stops) > 0) {
-                distance += distances_between_stops_.at(pair_of_stops);
-            } else if (distances_between_stops_.count(pair_of_stops_reverse) > 0) {
-                distance += distances_between_stops_.at(pair_of_stops_reverse);
+    std::optional<int> TransportCatalogue::FindRoadDistance(const domain::Stop* from, const domain::Stop* to) const {
+        for (const RoadDistance& item : distances_between_stops_[from->id_]) {
+            if (item.to_ == to->id_) {
+                return item.distance_;
             }
         }
-        return distance;
+        return std::nullopt;
     }
 
-    int TransportCatalogue::CountDistanceOnSegmentBackward(const domain::Bus& bus, size_t start) const {
+    int TransportCatalogue::ComputeRoadDistance(const domain::Bus& bus) const {
         int distance = 0;
-        for (size_t i = start; i > 0; i--) {
-            std::pair<const domain::Stop*, const domain::Stop*> pair_of_stops(bus.stops_[i], bus.stops_[i - 1]);
-            std::pair<const domain::Stop*, const domain::Stop*> pair_of_stops_reverse(bus.stops_[i - 1], bus.stops_[i]);
-            if (distances_between_stops_.count(pair_of_stops) > 0) {
-                distance += distances_between_stops_.at(pair_of_stops);
-            } else if (distances_between_stops_.count(pair_of_stops_reverse) > 0) {
-                distance += distances_between_stops_.at(pair_of_stops_reverse);
+        for (size_t i = 0; i + 1 < bus.stops_.size(); i++) {
+            distance += FindRoadDistance(bus.stops_[i], bus.stops_[i + 1]).value_or(0);
+            if (bus.type_ == domain::BusType::REVERSE) {
+                distance += FindRoadDistance(bus.stops_[i + 1], bus.stops_[i]).value_or(0);
             }
         }
+        if (bus.type_ == domain::BusType::CIRCULAR) {
+            distance += FindRoadDistance(bus.stops_.back(), bus.stops_[0]).value_or(0);
+        }
         return distance;
     }
 
-    int TransportCatalogue::ComputeRoadDistance(const domain::Bus& bus) const {
-        int distance = 0;
-        if (bus.type_ == domain::BusType::CIRCULAR) {
-            distance += CountDistanceOnSegmentForward(bus, bus.stops_.size() - 1);
-            std::pair<const domain::Stop*, const domain::Stop*> pair_of_stops(bus.stops_.back(), bus.stops_[0]);
-            std::pair<const domain::Stop*, const domain::Stop*> pair_of_stops_reverse(bus.stops_[0], bus.stops_.back());
-            if (distances_between_stops_.count(pair_of_stops) > 0) {
-                distance += distances_between_stops_.at(pair_of_stops);
-            } else if (distances_between_stops_.count(pair_of_stops_reverse) > 0) {
-                distance += distances_between_stops_.at(pair_of_stops_reverse);
+    namespace {
+        // Only the stops and buses found by name are indexed, which leaves out removed buses.
+        template <typename Item, typename FindByName>
+        perfect_hash::NameIndex MakeNameIndex(const std::deque<Item>& items, FindByName find_by_name) {
+            std::vector<std::string_view> names;
+            std::vector<uint32_t> ids;
+            names.reserve(items.size());
+            ids.reserve(items.size());
+            for (const Item& item : items) {
+                if (find_by_name(item.name_) == &item) {
+                    names.push_back(item.name_);
+                    ids.push_back(item.id_);
+                }
             }
-        } else {
-            distance += CountDistanceOnSegmentForward(bus, bus.stops_.size() - 1);
-            distance += CountDistanceOnSegmentBackward(bus,  bus.stops_.size() - 1);
+            return {names, ids};
         }
-        return distance;
+
+        spatial::GridIndex MakeStopGrid(const TransportCatalogue& transport_catalogue) {
+            std::vector<spatial::Point> points;
+            for (const domain::Stop* stop : transport_catalogue.GetSortedStops()) {
+                points.push_back({stop->id_, {stop->latitude_, stop->longitude_}});
+            }
+            return spatial::GridIndex{std::move(points)};
+        }
+    }
+
+    FrozenTransportCatalogue::FrozenTransportCatalogue(const TransportCatalogue& transport_catalogue)
+            : transport_catalogue_(transport_catalogue)
+            , stop_index_(MakeNameIndex(transport_catalogue.GetStops(), [&transport_catalogue](std::string_view name) {
+                return transport_catalogue.FindStop(name);
+            }))
+            , bus_index_(MakeNameIndex(transport_catalogue.GetBuses(), [&transport_catalogue](std::string_view name) {
+                return transport_catalogue.FindBus(name);
+            }))
+            , stop_grid_(MakeStopGrid(transport_catalogue))
+    {
+        FillStopBuses();
+    }
+
+    FrozenTransportCatalogue::FrozenTransportCatalogue(const TransportCatalogue& transport_catalogue,
+                                                       perfect_hash::NameIndex stop_index,
+                                                       perfect_hash::NameIndex bus_index,
+                                                       spatial::GridIndex stop_grid)
+            : transport_catalogue_(transport_catalogue)
+            , stop_index_(std::move(stop_index))
+            , bus_index_(std::move(bus_index))
+            , stop_grid_(std::move(stop_grid))
+    {
+        FillStopBuses();
+    }
+
+    const domain::Bus* FrozenTransportCatalogue::FindBus(std::string_view name) const {
+        const uint32_t id = bus_index_.Find(name);
+        if (id == perfect_hash::NameIndex::NOT_FOUND) return nullptr;
+        return &transport_catalogue_.GetBuses()[id];
+    }
+
+    const domain::Stop* FrozenTransportCatalogue::FindStop(std::string_view name) const {
+        const uint32_t id = stop_index_.Find(name);
+        if (id == perfect_hash::NameIndex::NOT_FOUND) return nullptr;
+        return &transport_catalogue_.GetStops()[id];
+    }
+
+    std::optional<domain::BusInfo> FrozenTransportCatalogue::GetBusInfo(std::string_view name) const {
+        const domain::Bus* bus = FindBus(name);
+        if (bus == nullptr) return std::nullopt;
+        return transport_catalogue_.GetBusInfo(*bus);
+    }
+
+    std::optional<domain::StopInfo> FrozenTransportCatalogue::GetStopInfo(std::string_view name) const {
+        const domain::Stop* stop = FindStop(name);
+        if (stop == nullptr) return std::nullopt;
+        domain::StopInfo info{stop->name_, {}};
+        info.buses_.reserve(stop_bus_offsets_[stop->id_ + 1] - stop_bus_offsets_[stop->id_]);
+        for (uint32_t i = stop_bus_offsets_[stop->id_]; i < stop_bus_offsets_[stop->id_ + 1]; ++i) {
+            info.buses_.push_back(transport_catalogue_.GetBuses()[stop_buses_[i]].name_);
+        }
+        return info;
+    }
+
+    std::vector<domain::NearbyStop> FrozenTransportCatalogue::FindStopsWithinRadius(geo::Coordinates point,
+                                                                                    double radius) const {
+        return MakeNearbyStops(stop_grid_.FindWithinRadius(point, radius));
+    }
+
+    std::vector<domain::NearbyStop> FrozenTransportCatalogue::FindNearestStops(geo::Coordinates point, size_t count,
+                                                                               double max_radius) const {
+        return MakeNearbyStops(stop_grid_.FindNearest(point, count, max_radius));
+    }
+
+    void FrozenTransportCatalogue::FillStopBuses() {
+        const std::deque<domain::Stop>& stops = transport_catalogue_.GetStops();
+        stop_bus_offsets_.reserve(stops.size() + 1);
+        stop_bus_offsets_.push_back(0);
+        for (const domain::Stop& stop : stops) {
+            const std::pmr::vector<uint32_t>& bus_ids = transport_catalogue_.GetStopBusIds(stop.id_);
+            stop_buses_.insert(stop_buses_.end(), bus_ids.begin(), bus_ids.end());
+            stop_bus_offsets_.push_back(static_cast<uint32_t>(stop_buses_.size()));
+        }
+    }
+
+    std::vector<domain::NearbyStop> FrozenTransportCatalogue::MakeNearbyStops(
+            const std::vector<spatial::Neighbour>& neighbours) const {
+        std::vector<domain::NearbyStop> stops;
+        stops.reserve(neighbours.size());
+        for (const spatial::Neighbour& neighbour : neighbours) {
+            stops.push_back({transport_catalogue_.GetStops()[neighbour.id].name_, neighbour.distance});
+        }
+        return stops;
+    }
+
+    const TransportCatalogue& FrozenTransportCatalogue::GetTransportCatalogue() const & {
+        return transport_catalogue_;
+    }
+
+    const perfect_hash::NameIndex& FrozenTransportCatalogue::GetStopIndex() const & {
+        return stop_index_;
+    }
+
+    const perfect_hash::NameIndex& FrozenTransportCatalogue::GetBusIndex() const & {
+        return bus_index_;
+    }
+
+    const spatial::GridIndex& FrozenTransportCatalogue::GetStopGrid() const & {
+        return stop_grid_;
     }
 }
\ No newline at end of file
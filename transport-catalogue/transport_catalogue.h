@@ -2,8 +2,9 @@
 
 #include "geo.h"
 #include "domain.h"
+#include "perfect_hash.h"
+#include "spatial_index.h"
 #include <unordered_set>
-#include <set>
 #include <unordered_map>
 #include <vector>
 #include <deque>
@@ -15,51 +16,123 @@
 #include <iostream>
 #include <iomanip>
 #include <optional>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <memory_resource>
 
 
 namespace transport_catalogue {
 
-    class Hasher {
-    private:
-        std::hash<const domain::Stop*> hasher_;
-    public:
-        size_t operator()(const std::pair<const domain::Stop*, const domain::Stop*>& pointers) const {
-            return static_cast<size_t>(hasher_(pointers.first) * 37 * 37 + hasher_(pointers.second));
-        }
+    // A reverse distance stands in for a missing direct one.
+    struct RoadDistance {
+        uint32_t to_;
+        int distance_;
+        bool is_reverse_;
+    };
+
+    struct StopsDistance {
+        std::string from_;
+        std::string to_;
+        int distance_ = 0;
+    };
+
+    // A batch of changes to the bus network. Removals are applied first, so a bus can be replaced in one batch.
+    struct CatalogueDeltas {
+        std::vector<domain::RawBus> added_buses_;
+        std::vector<std::string> removed_buses_;
+        std::vector<StopsDistance> changed_distances_;
     };
 
     class TransportCatalogue {
     public:
+        TransportCatalogue() = default;
+        // Assignment would free memory the containers still use.
+        TransportCatalogue(TransportCatalogue&& other) = default;
+        TransportCatalogue& operator=(TransportCatalogue&& other) = delete;
+
         void AddStop(domain::Stop stop);
         void AddBus(domain::RawBus raw_bus);
         void AddStopsDistances(const std::pair<std::string, std::unordered_map<std::string, int>>& distances);
         void AddStopsDistancesByPair(std::string_view from, std::string_view to, int distance);
+        // A removed bus keeps its place in GetBuses() with no stops, so bus indices stay valid.
+        void RemoveBus(std::string_view name);
+        void SetStopsDistance(std::string_view from, std::string_view to, int distance);
+        void ApplyDeltas(const CatalogueDeltas& deltas);
         const domain::Bus* FindBus(std::string_view name) const;
         const domain::Stop* FindStop(std::string_view name) const;
         std::optional<domain::BusInfo> GetBusInfo(std::string_view name) const;
         std::optional<domain::StopInfo> GetStopInfo(std::string_view name) const;
+        domain::BusInfo GetBusInfo(const domain::Bus& bus) const;
+        domain::StopInfo GetStopInfo(const domain::Stop& stop) const;
         const std::deque<domain::Stop>& GetStops() const &;
         const std::deque<domain::Bus>& GetBuses() const &;
         std::vector<const domain::Bus*> GetSortedBuses() const;
         std::vector<const domain::Stop*> GetSortedStops() const;
         std::vector<geo::Coordinates> GetValidCoordinates() const;
-        const std::unordered_map<std::string_view, const domain::Bus*>& GetBusIndexes() const;
-        const std::unordered_map<std::pair<const domain::Stop*, const domain::Stop*>, int, Hasher>& GetDistancess() const &;
+        const std::pmr::vector<RoadDistance>& GetRoadDistances(uint32_t stop_id) const &;
+        const std::pmr::vector<uint32_t>& GetStopBusIds(uint32_t stop_id) const &;
         int GetDistancesBetweenStops(const domain::Stop* stop_1, const domain::Stop* stop_2) const;
         std::vector<std::string_view> GetUsedStopNames() const;
         size_t GetAmountOfUsedStops() const;
 
     private:
+        std::string_view InternName(std::string_view name);
+        void InsertRoadDistance(uint32_t from, uint32_t to, int distance, bool overwrite);
+        void ComputeBusStatistics(domain::Bus& bus) const;
         double ComputeGeographicalDistance(const domain::Bus& bus) const;
         int ComputeRoadDistance(const domain::Bus& bus) const;
-        int CountDistanceOnSegmentForward(const domain::Bus& bus, size_t finish) const;
-        int CountDistanceOnSegmentBackward(const domain::Bus& bus, size_t start) const;
+        std::optional<int> FindRoadDistance(const domain::Stop* from, const domain::Stop* to) const;
+
+        // Declared before the containers allocating from them.
+        std::unique_ptr<std::pmr::monotonic_buffer_resource> arena_ = std::make_unique<std::pmr::monotonic_buffer_resource>();
+        std::unique_ptr<std::pmr::unsynchronized_pool_resource> pool_ = std::make_unique<std::pmr::unsynchronized_pool_resource>();
 
         std::deque<domain::Stop> stops_;
         std::deque<domain::Bus> buses_;
-        std::unordered_map<std::string_view, const domain::Stop*> stop_indexes_;
-        std::unordered_map<std::string_view, const domain::Bus*> buses_indexes_;
-        std::unordered_map<std::pair<const domain::Stop*, const domain::Stop*>, int, Hasher> distances_between_stops_;
-        std::unordered_map<const domain::Stop*, std::set<std::string_view>> buses_through_the_stop_indexes_;
+        std::pmr::unordered_map<std::string_view, uint32_t> stop_indexes_{pool_.get()};
+        std::pmr::unordered_map<std::string_view, uint32_t> buses_indexes_{pool_.get()};
+        std::pmr::vector<std::pmr::vector<RoadDistance>> distances_between_stops_{pool_.get()};
+        // Sorted by bus name.
+        std::pmr::vector<std::pmr::vector<uint32_t>> buses_through_the_stop_indexes_{pool_.get()};
+        // The last bus added through a stop, plus one.
+        std::pmr::vector<uint32_t> last_bus_marks_{pool_.get()};
+        size_t used_stop_count_ = 0;
+    };
+
+    // Read-only snapshot of a built catalogue, rebuilt after it changes.
+    class FrozenTransportCatalogue {
+    public:
+        explicit FrozenTransportCatalogue(const TransportCatalogue& transport_catalogue);
+        FrozenTransportCatalogue(const TransportCatalogue& transport_catalogue,
+                                 perfect_hash::NameIndex stop_index, perfect_hash::NameIndex bus_index,
+                                 spatial::GridIndex stop_grid);
+
+        const domain::Bus* FindBus(std::string_view name) const;
+        const domain::Stop* FindStop(std::string_view name) const;
+        std::optional<domain::BusInfo> GetBusInfo(std::string_view name) const;
+        std::optional<domain::StopInfo> GetStopInfo(std::string_view name) const;
+        // Stops served by buses, nearest first.
+        std::vector<domain::NearbyStop> FindStopsWithinRadius(geo::Coordinates point, double radius) const;
+        std::vector<domain::NearbyStop> FindNearestStops(geo::Coordinates point, size_t count,
+                                                         double max_radius = std::numeric_limits<double>::infinity()) const;
+        const TransportCatalogue& GetTransportCatalogue() const &;
+        const perfect_hash::NameIndex& GetStopIndex() const &;
+        const perfect_hash::NameIndex& GetBusIndex() const &;
+        const spatial::GridIndex& GetStopGrid() const &;
+
+    private:
+        const TransportCatalogue& transport_catalogue_;
+        perfect_hash::NameIndex stop_index_;
+        perfect_hash::NameIndex bus_index_;
+        spatial::GridIndex stop_grid_;
+        // The buses of stop i are stop_buses_[stop_bus_offsets_[i], stop_bus_offsets_[i + 1]), sorted by name.
+        std::vector<uint32_t> stop_bus_offsets_;
+        std::vector<uint32_t> stop_buses_;
+
+        void FillStopBuses();
+        std::vector<domain::NearbyStop> MakeNearbyStops(const std::vector<spatial::Neighbour>& neighbours) const;
     };
 }
\ No newline at end of file
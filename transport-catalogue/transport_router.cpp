@@ -1,51 +1,98 @@
 #include "transport_router.h"
 
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <tuple>
+
 namespace transport_router {
     TransportRouter::TransportRouter(RoutingSettings settings, const transport_catalogue::TransportCatalogue &transport_catalogue)
             : routing_settings_(settings),
               transport_catalogue_(transport_catalogue),
-              graph_(std::make_unique<Graph>(transport_catalogue_.GetAmountOfUsedStops() * 2)),
-              router_(nullptr)
+              graph_(std::make_unique<Graph>(CountGraphVertices())),
+              route_cache_(std::make_unique<RouteCache>(routing_settings_.route_cache_capacity_)),
+              customized_routers_(std::make_unique<CustomizedRouterCache>(CUSTOMIZED_ROUTERS_CACHE_CAPACITY))
     {
-        FillGraph();
-        router_ = std::make_unique<Router>(*graph_);
+        stop_names_ = transport_catalogue_.GetUsedStopNames();
+        if (routing_settings_.engine_ == EngineType::RAPTOR) {
+            BuildRaptorGraph();
+            return;
+        }
+        RebuildGraph();
+        SelectRouterEngine();
+        BuildRouterEngine();
     }
 
     TransportRouter::TransportRouter(RoutingSettings routing_settings,
                                      const transport_catalogue::TransportCatalogue& transport_catalogue,
                                      std::unique_ptr<Graph>&& graph,
-                                     std::unique_ptr<Router>&& router,
+                                     RouterEngine&& router,
                                      std::unordered_map<std::string_view, std::pair<size_t, size_t>>&& pairs_of_vertices_for_each_stop,
-                                     EdgeDescriptions&& edges_descriptions)
+                                     EdgeRecords&& edge_records,
+                                     AlternativeBuses&& alternative_buses,
+                                     EngineEstimates&& engine_estimates)
             : routing_settings_(routing_settings),
               transport_catalogue_(transport_catalogue),
               graph_(std::move(graph)),
               router_(std::move(router)),
               pairs_of_vertices_for_each_stop_(std::move(pairs_of_vertices_for_each_stop)),
-              edges_descriptions_(std::move(edges_descriptions)) {}
+              edge_records_(std::move(edge_records)),
+              alternative_buses_(std::move(alternative_buses)),
+              stop_names_(transport_catalogue_.GetUsedStopNames()),
+              route_cache_(std::make_unique<RouteCache>(routing_settings_.route_cache_capacity_)),
+              customized_routers_(std::make_unique<CustomizedRouterCache>(CUSTOMIZED_ROUTERS_CACHE_CAPACITY)),
+              engine_estimates_(std::move(engine_estimates))
+    {
+        FillBusDistances();
+        if (routing_settings_.engine_ == EngineType::RAPTOR) {
+            BuildRaptorRouter();
+        }
+    }
 
+    // first_stop is the position of *first in the bus traversal.
     template<typename InputIterator>
-    void AddBusEdgesToGraph(TransportRouter& transport_router, InputIterator first, InputIterator last, std::string_view bus_name) {
-        for (; std::distance(first, last) != 1; first++) {
+    void AddBusEdgesToGraph(TransportRouter& transport_router, InputIterator first, InputIterator last,
+                            uint32_t bus_index, uint32_t first_stop) {
+        const RouteMetric metric = transport_router.GetRouteMetric();
+        for (; std::distance(first, last) != 1; ++first, ++first_stop) {
             graph::VertexId from_id = transport_router.GetPairsOfVertices().at((*first)->name_).second;
-            const domain::Stop* from_stop = *first;
-            double time = 0.0;
             InputIterator next_after_first = first;
-            for (std::advance(next_after_first, 1); next_after_first != last; next_after_first++) {
+            uint32_t span_count = 1;
+            for (std::advance(next_after_first, 1); next_after_first != last; ++next_after_first, ++span_count) {
                 graph::VertexId to_id = transport_router.GetPairsOfVertices().at((*next_after_first)->name_).first;
-                time += transport_router.GetTransportCatalogue().GetDistancesBetweenStops(from_stop,*next_after_first) /
-                        METERS_PER_KM / transport_router.GetRoutingSettings().bus_velocity_ * MIN_PER_HOUR;
+                EdgeRecord record{EdgeType::BUS, bus_index, first_stop, span_count};
+                transport_router.GetGraph()->AddEdge({from_id, to_id, transport_router.ComputeEdgeTime(record, metric)});
+                transport_router.GetEdgeRecords().push_back(record);
+            }
+        }
+    }
 
-                transport_router.GetGraph()->AddEdge({from_id, to_id, time});
-                from_stop = *next_after_first;
-                transport_router.GetEdgeDescription().push_back({
-                                                      EdgeType::BUS,
-                                                      bus_name,
-                                                      time,
-                                                      std::distance(first, next_after_first)
-                                              });
+    // Boarding edges carry the wait time, ride edges join neighbouring stops of the bus
+    // and free alighting edges lead back to the stop vertex. Returns the next unused vertex id.
+    // Stop vertices of the trip-based graph are numbered in used stop order, so a stop vertex is also the stop index.
+    template<typename InputIterator>
+    graph::VertexId AddBusRideEdgesToGraph(TransportRouter& transport_router, InputIterator first, InputIterator last,
+                                           uint32_t bus_index, uint32_t first_stop, graph::VertexId ride_vertex) {
+        const RouteMetric metric = transport_router.GetRouteMetric();
+        for (InputIterator current = first; current != last; ++current, ++ride_vertex, ++first_stop) {
+            graph::VertexId stop_vertex = transport_router.GetPairsOfVertices().at((*current)->name_).first;
+            const auto stop_index = static_cast<uint32_t>(stop_vertex);
+            InputIterator next = std::next(current);
+            if (current != first) {
+                transport_router.GetGraph()->AddEdge({ride_vertex, stop_vertex, 0.0});
+                transport_router.GetEdgeRecords().push_back({EdgeType::ALIGHT, stop_index});
             }
+            if (next == last) {
+                continue;
+            }
+            transport_router.GetGraph()->AddEdge({stop_vertex, ride_vertex, metric.bus_wait_time_});
+            transport_router.GetEdgeRecords().push_back({EdgeType::WAIT, stop_index});
+
+            EdgeRecord record{EdgeType::BUS, bus_index, first_stop, 1};
+            transport_router.GetGraph()->AddEdge({ride_vertex, ride_vertex + 1, transport_router.ComputeEdgeTime(record, metric)});
+            transport_router.GetEdgeRecords().push_back(record);
         }
+        return ride_vertex;
     }
 
     const RoutingSettings& TransportRouter::GetRoutingSettings() const & {
@@ -60,60 +107,715 @@ namespace transport_router {
     const std::unique_ptr<Graph> &TransportRouter::GetGraph() const & {
         return graph_;
     }
-    const std::unique_ptr<Router>& TransportRouter::GetRouter() const & {
+    const RouterEngine& TransportRouter::GetRouter() const & {
         return router_;
     }
-    EdgeDescriptions& TransportRouter::GetEdgeDescription() & {
-        return edges_descriptions_;
+    EdgeRecords& TransportRouter::GetEdgeRecords() & {
+        return edge_records_;
     }
     const std::unordered_map<std::string_view, std::pair<size_t, size_t>>& TransportRouter::GetPairsOfVertices() const & {
         return pairs_of_vertices_for_each_stop_;
     }
-    const EdgeDescriptions &TransportRouter::GetEdgeDescriptions() const &{
-        return edges_descriptions_;
+    const EdgeRecords& TransportRouter::GetEdgeRecords() const & {
+        return edge_records_;
+    }
+    const AlternativeBuses& TransportRouter::GetAlternativeBuses() const & {
+        return alternative_buses_;
+    }
+    const EngineEstimates& TransportRouter::GetEngineEstimates() const & {
+        return engine_estimates_;
+    }
+    RouteMetric TransportRouter::GetRouteMetric() const {
+        return {routing_settings_.bus_wait_time_, routing_settings_.bus_velocity_};
+    }
+
+    double TransportRouter::GetBusDistance(uint32_t bus_index, uint32_t first_stop, uint32_t span_count) const {
+        const double* distances = &bus_distances_[bus_distance_offsets_[bus_index] + first_stop];
+        return distances[span_count] - distances[0];
+    }
+
+    double TransportRouter::ComputeEdgeTime(const EdgeRecord& record, const RouteMetric& metric) const {
+        switch (record.type_) {
+            case EdgeType::WAIT:
+                return metric.bus_wait_time_;
+            case EdgeType::BUS:
+                return GetBusDistance(record.index_, record.first_stop_, record.span_count_) / METERS_PER_KM / metric.bus_velocity_ * MIN_PER_HOUR;
+            default:
+                return 0.0;
+        }
+    }
+
+    RouteDescription TransportRouter::BuildRoute(std::string_view stop_from, std::string_view stop_to) const {
+        if (stop_from == stop_to) return std::make_shared<const EdgeDescriptions>();
+
+        auto from_it = pairs_of_vertices_for_each_stop_.find(stop_from);
+        auto to_it = pairs_of_vertices_for_each_stop_.find(stop_to);
+        if (from_it == pairs_of_vertices_for_each_stop_.end() || to_it == pairs_of_vertices_for_each_stop_.end()) return nullptr;
+
+        const std::pair<graph::VertexId, graph::VertexId> vertices{from_it->second.first, to_it->second.first};
+        if (std::optional<RouteDescription> cached_route = route_cache_->Get(vertices)) {
+            return *cached_route;
+        }
+        RouteDescription route_description = raptor_router_ ?
+                BuildRaptorRoutes(vertices.first, {vertices.second}, GetRouteMetric()).front() :
+                MakeRouteDescription(std::visit([&vertices](const auto& router) {
+                    return router->BuildRoute(vertices.first, vertices.second);
+                }, router_), *graph_);
+        route_cache_->Put(vertices, route_description);
+        return route_description;
     }
 
-    std::optional<EdgeDescriptions> TransportRouter::BuildRoute(std::string_view stop_from, std::string_view stop_to) const {
-        EdgeDescriptions result;
+    std::vector<RouteDescription> TransportRouter::BuildRoutes(std::string_view stop_from,
+                                                               const std::vector<std::string_view>& stops_to) const {
+        std::vector<RouteDescription> result(stops_to.size());
+        auto from_it = pairs_of_vertices_for_each_stop_.find(stop_from);
+
+        std::vector<size_t> missed_indexes;
+        std::vector<graph::VertexId> missed_vertices;
+        for (size_t i = 0; i < stops_to.size(); ++i) {
+            if (stops_to[i] == stop_from) {
+                result[i] = std::make_shared<const EdgeDescriptions>();
+                continue;
+            }
+            auto to_it = pairs_of_vertices_for_each_stop_.find(stops_to[i]);
+            if (from_it == pairs_of_vertices_for_each_stop_.end() || to_it == pairs_of_vertices_for_each_stop_.end()) {
+                continue;
+            }
+            if (std::optional<RouteDescription> cached_route = route_cache_->Get({from_it->second.first, to_it->second.first})) {
+                result[i] = std::move(*cached_route);
+                continue;
+            }
+            missed_indexes.push_back(i);
+            missed_vertices.push_back(to_it->second.first);
+        }
+        if (missed_vertices.empty()) {
+            return result;
+        }
 
-        if (stop_from == stop_to) return result;
-        if (pairs_of_vertices_for_each_stop_.count(stop_from) == 0
-            || pairs_of_vertices_for_each_stop_.count(stop_to) == 0) return std::nullopt;
+        const graph::VertexId from_id = from_it->second.first;
+        std::vector<RouteDescription> routes;
+        if (raptor_router_) {
+            routes = BuildRaptorRoutes(from_id, missed_vertices, GetRouteMetric());
+        } else {
+            for (const auto& route : std::visit([from_id, &missed_vertices](const auto& router) {
+                return router->BuildRoutes(from_id, missed_vertices);
+            }, router_)) {
+                routes.push_back(MakeRouteDescription(route, *graph_));
+            }
+        }
+        for (size_t i = 0; i < routes.size(); ++i) {
+            result[missed_indexes[i]] = routes[i];
+            route_cache_->Put({from_id, missed_vertices[i]}, result[missed_indexes[i]]);
+        }
+        return result;
+    }
 
-        graph::VertexId from_id = pairs_of_vertices_for_each_stop_.at(stop_from).first;
-        graph::VertexId to = pairs_of_vertices_for_each_stop_.at(stop_to).first;
-        std::optional<Router::RouteInfo> route = router_->BuildRoute(from_id, to);
+    std::vector<RouteDescription> TransportRouter::BuildRoutes(std::string_view stop_from,
+                                                               const std::vector<std::string_view>& stops_to,
+                                                               const RouteMetric& metric) const {
+        if (metric == GetRouteMetric()) {
+            return BuildRoutes(stop_from, stops_to);
+        }
+        if (!(metric.bus_velocity_ > 0.0) || metric.bus_wait_time_ < 0.0) {
+            throw std::invalid_argument("Bus velocity should be positive and wait time non-negative");
+        }
 
-        if (!route.has_value()) return std::nullopt;
+        std::vector<RouteDescription> result(stops_to.size());
+        auto from_it = pairs_of_vertices_for_each_stop_.find(stop_from);
+        std::vector<size_t> target_indexes;
+        std::vector<graph::VertexId> targets;
+        for (size_t i = 0; i < stops_to.size(); ++i) {
+            if (stops_to[i] == stop_from) {
+                result[i] = std::make_shared<const EdgeDescriptions>();
+                continue;
+            }
+            auto to_it = pairs_of_vertices_for_each_stop_.find(stops_to[i]);
+            if (from_it != pairs_of_vertices_for_each_stop_.end() && to_it != pairs_of_vertices_for_each_stop_.end()) {
+                target_indexes.push_back(i);
+                targets.push_back(to_it->second.first);
+            }
+        }
+        if (targets.empty()) {
+            return result;
+        }
+        // RAPTOR takes ride times straight from the metric, so it needs no customized graph.
+        if (raptor_router_) {
+            std::vector<RouteDescription> routes = BuildRaptorRoutes(from_it->second.first, targets, metric);
+            for (size_t i = 0; i < routes.size(); ++i) {
+                result[target_indexes[i]] = std::move(routes[i]);
+            }
+            return result;
+        }
 
-        for (graph::VertexId id : route.value().edges) {
-            result.push_back(edges_descriptions_[id]);
+        const std::shared_ptr<const CustomizedRouter> customized_router = GetCustomizedRouter(metric);
+        auto routes = customized_router->router_->BuildRoutes(from_it->second.first, targets);
+        for (size_t i = 0; i < routes.size(); ++i) {
+            result[target_indexes[i]] = MakeRouteDescription(routes[i], *customized_router->graph_);
         }
         return result;
     }
 
+    // Customization only recomputes edge weights from the stored distances and never touches the topology,
+    // so it takes a single pass over the edges.
+    std::shared_ptr<const CustomizedRouter> TransportRouter::GetCustomizedRouter(const RouteMetric& metric) const {
+        if (std::optional<std::shared_ptr<const CustomizedRouter>> cached_router = customized_routers_->Get(metric)) {
+            return *cached_router;
+        }
+        std::vector<double> weights;
+        weights.reserve(edge_records_.size());
+        for (const EdgeRecord& record : edge_records_) {
+            weights.push_back(ComputeEdgeTime(record, metric));
+        }
+        auto customized_router = std::make_shared<CustomizedRouter>();
+        customized_router->graph_ = std::make_unique<Graph>(graph_->WithWeights(weights));
+        customized_router->router_ = std::make_unique<DijkstraRouter>(*customized_router->graph_);
+        customized_routers_->Put(metric, customized_router);
+        return customized_router;
+    }
+
+    cache::CacheStatistics TransportRouter::GetRouteCacheStatistics() const {
+        return route_cache_->GetStatistics();
+    }
+
+    std::optional<graph::SearchStatistics> TransportRouter::GetSearchStatistics() const {
+        if (auto alt_router = std::get_if<std::unique_ptr<AltRouter>>(&router_)) {
+            return (*alt_router)->GetSearchStatistics();
+        }
+        return std::nullopt;
+    }
+
+    RouterUpdateStatistics TransportRouter::ApplyCatalogueDeltas(const transport_catalogue::CatalogueDeltas& deltas) {
+        route_cache_ = std::make_unique<RouteCache>(routing_settings_.route_cache_capacity_);
+        customized_routers_ = std::make_unique<CustomizedRouterCache>(CUSTOMIZED_ROUTERS_CACHE_CAPACITY);
+        RouterUpdateStatistics statistics;
+        if (raptor_router_) {
+            stop_names_ = transport_catalogue_.GetUsedStopNames();
+            BuildRaptorGraph();
+            statistics.rebuilt_ = true;
+            return statistics;
+        }
+
+        const bool buses_changed = !deltas.added_buses_.empty() || !deltas.removed_buses_.empty();
+        std::vector<std::string_view> stop_names = transport_catalogue_.GetUsedStopNames();
+        if (stop_names != stop_names_ || (routing_settings_.graph_model_ == GraphModel::TRIP_BASED && buses_changed)) {
+            stop_names_ = std::move(stop_names);
+            RebuildGraph();
+            BuildRouterEngine();
+            statistics.rebuilt_ = true;
+            return statistics;
+        }
+
+        // The engine keeps a reference to *graph_, so the new graph takes its place and the old one moves out.
+        const Graph old_graph(std::move(*graph_));
+        RebuildGraph();
+
+        // After pruning an edge is identified by the vertices it joins.
+        std::vector<std::optional<graph::EdgeId>> new_edge_ids(old_graph.GetEdgeCount());
+        std::vector<graph::EdgeId> raised_edges;
+        std::vector<graph::EdgeId> lowered_edges;
+        std::unordered_map<graph::VertexId, graph::EdgeId> old_edges;
+        bool edge_ids_changed = graph_->GetEdgeCount() != old_graph.GetEdgeCount();
+        for (graph::VertexId from = 0; from < graph_->GetVertexCount(); ++from) {
+            old_edges.clear();
+            for (graph::EdgeId edge_id : old_graph.GetIncidentEdges(from)) {
+                old_edges.emplace(old_graph.GetEdge(edge_id).to, edge_id);
+            }
+            for (graph::EdgeId edge_id : graph_->GetIncidentEdges(from)) {
+                const auto& edge = graph_->GetEdge(edge_id);
+                auto old_edge = old_edges.find(edge.to);
+                if (old_edge == old_edges.end()) {
+                    lowered_edges.push_back(edge_id);
+                    continue;
+                }
+                const double old_weight = old_graph.GetEdge(old_edge->second).weight;
+                if (edge.weight < old_weight) {
+                    lowered_edges.push_back(edge_id);
+                } else if (edge.weight > old_weight) {
+                    raised_edges.push_back(old_edge->second);
+                }
+                new_edge_ids[old_edge->second] = edge_id;
+                edge_ids_changed = edge_ids_changed || edge_id != old_edge->second;
+                old_edges.erase(old_edge);
+            }
+            for (auto [to, edge_id] : old_edges) {
+                raised_edges.push_back(edge_id);
+            }
+        }
+        statistics.raised_edges_ = raised_edges.size();
+        statistics.lowered_edges_ = lowered_edges.size();
+        if (raised_edges.empty() && lowered_edges.empty() && !edge_ids_changed) {
+            return statistics;
+        }
+
+        const size_t threads = routing_settings_.precompute_threads_;
+        if (auto router = std::get_if<std::unique_ptr<Router>>(&router_)) {
+            statistics.searched_rows_ = (*router)->Update(new_edge_ids, raised_edges, lowered_edges, threads);
+        } else if (auto float_router = std::get_if<std::unique_ptr<FloatRouter>>(&router_)) {
+            statistics.searched_rows_ = (*float_router)->Update(new_edge_ids, raised_edges, lowered_edges, threads);
+        } else if (auto fixed_point_router = std::get_if<std::unique_ptr<FixedPointRouter>>(&router_)) {
+            statistics.searched_rows_ = (*fixed_point_router)->Update(new_edge_ids, raised_edges, lowered_edges, threads);
+        } else if (!std::holds_alternative<std::unique_ptr<DijkstraRouter>>(router_)) {
+            // Shortcuts, labels and landmark distances all depend on the whole graph, so these engines start over.
+            BuildRouterEngine();
+        }
+        return statistics;
+    }
+
+    TimeMatrix TransportRouter::BuildTimeMatrix(const std::vector<std::string_view>& stops_from,
+                                                const std::vector<std::string_view>& stops_to) const {
+        auto collect_vertices = [this](const std::vector<std::string_view>& stops,
+                                       std::vector<size_t>& indexes, std::vector<graph::VertexId>& vertices) {
+            for (size_t i = 0; i < stops.size(); ++i) {
+                auto it = pairs_of_vertices_for_each_stop_.find(stops[i]);
+                if (it != pairs_of_vertices_for_each_stop_.end()) {
+                    indexes.push_back(i);
+                    vertices.push_back(it->second.first);
+                }
+            }
+        };
+        std::vector<size_t> source_indexes, target_indexes;
+        std::vector<graph::VertexId> sources, targets;
+        collect_vertices(stops_from, source_indexes, sources);
+        collect_vertices(stops_to, target_indexes, targets);
+
+        std::vector<std::optional<double>> weights;
+        if (raptor_router_) {
+            weights.reserve(sources.size() * targets.size());
+            for (const graph::VertexId source : sources) {
+                const std::vector<double> arrivals = SearchRaptor(source, targets, GetRouteMetric()).arrivals;
+                for (const graph::VertexId target : targets) {
+                    weights.push_back(arrivals[target] == raptor::RaptorRouter::UNREACHABLE_TIME ?
+                                      std::nullopt : std::optional<double>(arrivals[target]));
+                }
+            }
+        } else {
+            weights = std::visit([&sources, &targets](const auto& router) {
+                return router->BuildWeightMatrix(sources, targets);
+            }, router_);
+        }
+
+        TimeMatrix time_matrix(stops_from.size(), std::vector<std::optional<double>>(stops_to.size()));
+        for (size_t i = 0; i < sources.size(); ++i) {
+            for (size_t j = 0; j < targets.size(); ++j) {
+                time_matrix[source_indexes[i]][target_indexes[j]] = weights[i * targets.size() + j];
+            }
+        }
+        for (size_t i = 0; i < stops_from.size(); ++i) {
+            for (size_t j = 0; j < stops_to.size(); ++j) {
+                if (stops_from[i] == stops_to[j]) {
+                    time_matrix[i][j] = 0.0;
+                }
+            }
+        }
+        return time_matrix;
+    }
+
+    // Runs a bounded Dijkstra search over the routing graph itself, so it works with any engine
+    // and the arrival times are the same totals Route would answer with.
+    std::optional<Isochrone> TransportRouter::BuildIsochrone(std::string_view stop_from, double max_time) const {
+        const domain::Stop* stop = transport_catalogue_.FindStop(stop_from);
+        if (stop == nullptr) return std::nullopt;
+
+        auto from_it = pairs_of_vertices_for_each_stop_.find(stop_from);
+        if (from_it == pairs_of_vertices_for_each_stop_.end()) {
+            return Isochrone{{stop->name_, 0.0}};
+        }
+
+        Isochrone isochrone;
+        if (raptor_router_) {
+            const std::vector<double> arrivals =
+                    SearchRaptor(from_it->second.first, {}, GetRouteMetric(), max_time).arrivals;
+            for (const auto& [stop_name, vertices] : pairs_of_vertices_for_each_stop_) {
+                if (arrivals[vertices.first] != raptor::RaptorRouter::UNREACHABLE_TIME) {
+                    isochrone.push_back({stop_name, arrivals[vertices.first]});
+                }
+            }
+        } else {
+            const graph::ShortestPathTree<double> tree =
+                    graph::BuildShortestPathTree(*graph_, from_it->second.first, {}, std::optional<double>(max_time));
+            for (const auto& [stop_name, vertices] : pairs_of_vertices_for_each_stop_) {
+                if (const std::optional<double>& time = tree.weights[vertices.first]) {
+                    isochrone.push_back({stop_name, *time});
+                }
+            }
+        }
+        std::sort(isochrone.begin(), isochrone.end(), [](const ReachableStop& lhs, const ReachableStop& rhs) {
+            return std::tie(lhs.time_, lhs.stop_name_) < std::tie(rhs.time_, rhs.stop_name_);
+        });
+        return isochrone;
+    }
+
+    // Item times come from the searched graph, so a route of a customized metric reports that metric's times.
+    RouteDescription TransportRouter::MakeRouteDescription(const std::optional<graph::RouteInfo<double>>& route,
+                                                           const Graph& graph) const {
+        if (!route.has_value()) return nullptr;
+
+        auto result = std::make_shared<EdgeDescriptions>();
+        // Consecutive ride edges of the trip-based graph are merged back into a single Bus item.
+        std::optional<EdgeType> prev_type;
+        for (graph::EdgeId id : route.value().edges) {
+            const EdgeRecord& record = edge_records_[id];
+            const double time = graph.GetEdge(id).weight;
+            if (record.type_ == EdgeType::BUS && prev_type == EdgeType::BUS) {
+                result->back().time_ += time;
+                result->back().span_count_ = *result->back().span_count_ + static_cast<int>(record.span_count_);
+                result->back().distance_ += GetBusDistance(record.index_, record.first_stop_, record.span_count_);
+            } else if (record.type_ != EdgeType::ALIGHT) {
+                result->push_back(MakeEdgeDescription(id, time));
+            }
+            prev_type = record.type_;
+        }
+        return result;
+    }
+
+    RouteDescription TransportRouter::MakeRouteDescription(const std::optional<raptor::Journey>& journey,
+                                                           const RouteMetric& metric) const {
+        if (!journey.has_value()) return nullptr;
+
+        auto result = std::make_shared<EdgeDescriptions>();
+        for (const raptor::Leg& leg : journey->legs) {
+            const EdgeRecord record{EdgeType::BUS, leg.bus_index, leg.first_stop, leg.span_count};
+            result->push_back({EdgeType::WAIT, stop_names_[leg.board_stop], metric.bus_wait_time_, std::nullopt});
+            result->push_back({EdgeType::BUS, transport_catalogue_.GetBuses()[leg.bus_index].name_,
+                               ComputeEdgeTime(record, metric), static_cast<int>(leg.span_count),
+                               GetBusDistance(leg.bus_index, leg.first_stop, leg.span_count)});
+        }
+        return result;
+    }
+
+    raptor::SearchTree TransportRouter::SearchRaptor(graph::VertexId from, const std::vector<graph::VertexId>& targets,
+                                                     const RouteMetric& metric, std::optional<double> max_time) const {
+        const std::vector<raptor::StopIndex> target_stops(targets.begin(), targets.end());
+        const double minutes_per_meter = MIN_PER_HOUR / (METERS_PER_KM * metric.bus_velocity_);
+        return raptor_router_->Search(static_cast<raptor::StopIndex>(from), target_stops, metric.bus_wait_time_,
+                                      minutes_per_meter, max_time);
+    }
+
+    std::vector<RouteDescription> TransportRouter::BuildRaptorRoutes(graph::VertexId from,
+                                                                     const std::vector<graph::VertexId>& targets,
+                                                                     const RouteMetric& metric) const {
+        const raptor::SearchTree tree = SearchRaptor(from, targets, metric);
+        std::vector<RouteDescription> routes;
+        routes.reserve(targets.size());
+        for (const graph::VertexId to : targets) {
+            routes.push_back(MakeRouteDescription(raptor_router_->ExtractJourney(tree, static_cast<raptor::StopIndex>(to)), metric));
+        }
+        return routes;
+    }
+
+    EdgeDescription TransportRouter::MakeEdgeDescription(graph::EdgeId edge_id, double time) const {
+        const EdgeRecord& record = edge_records_[edge_id];
+        EdgeDescription description{record.type_, {}, time, std::nullopt};
+        if (record.type_ == EdgeType::BUS) {
+            description.edge_name_ = transport_catalogue_.GetBuses()[record.index_].name_;
+            description.span_count_ = static_cast<int>(record.span_count_);
+            description.distance_ = GetBusDistance(record.index_, record.first_stop_, record.span_count_);
+        } else {
+            description.edge_name_ = stop_names_[record.index_];
+        }
+        if (auto alternatives = alternative_buses_.find(edge_id); alternatives != alternative_buses_.end()) {
+            description.alternative_buses_ = &alternatives->second;
+        }
+        return description;
+    }
+
+    // Preprocessing cost models, fitted on Release builds over the grid networks of 2k-20k stops.
+    constexpr static double BYTES_PER_MB = 1024.0 * 1024.0;
+    // Floyd-Warshall seconds per V^3 of one thread; compact matrix weights run the vectorized kernel.
+    constexpr static double ALL_PAIRS_SECONDS_PER_CUBED_VERTEX = 1.2e-10;
+    constexpr static double COMPACT_ALL_PAIRS_SECONDS_PER_CUBED_VERTEX = 6e-11;
+    // Contraction adds about 0.31 shortcuts per edge at 6.5 microseconds per edge.
+    constexpr static double SHORTCUTS_PER_EDGE = 0.31;
+    constexpr static double CONTRACTION_SECONDS_PER_EDGE = 6.5e-6;
+    // Label entries per vertex grow slowly with the graph: 56 at 4k vertices, 74 at 40k, 140 at 200k.
+    constexpr static double LABEL_ENTRIES_FACTOR = 8.0;
+    constexpr static double LABEL_ENTRIES_EXPONENT = 0.23;
+    constexpr static double LABELING_SECONDS_PER_ENTRY = 1e-6;
+    // One landmark Dijkstra, forward or backward, per edge.
+    constexpr static double LANDMARK_SEARCH_SECONDS_PER_EDGE = 3e-9;
+
+    std::string_view GetEngineName(EngineType engine) {
+        switch (engine) {
+            case EngineType::ALL_PAIRS:
+                return "all_pairs";
+            case EngineType::DIJKSTRA:
+                return "dijkstra";
+            case EngineType::CONTRACTION_HIERARCHIES:
+                return "contraction_hierarchies";
+            case EngineType::HUB_LABELS:
+                return "hub_labels";
+            case EngineType::ALT:
+                return "alt";
+            case EngineType::RAPTOR:
+                return "raptor";
+            case EngineType::AUTO:
+                return "auto";
+        }
+        return {};
+    }
+
+    EngineEstimates EstimateEngines(const RoutingSettings& settings, size_t vertex_count, size_t edge_count) {
+        const double vertices = static_cast<double>(vertex_count);
+        const double edges = static_cast<double>(edge_count);
+
+        const size_t thread_count = settings.precompute_threads_ == 0 ?
+                                    std::max<size_t>(std::thread::hardware_concurrency(), 1) :
+                                    settings.precompute_threads_;
+        const bool is_compact_matrix = settings.weight_type_ != WeightType::DOUBLE;
+        const double matrix_weight_size = is_compact_matrix ? sizeof(float) : sizeof(double);
+        EngineEstimate all_pairs{EngineType::ALL_PAIRS,
+                                 vertices * vertices * (matrix_weight_size + sizeof(uint32_t)),
+                                 vertices * vertices * vertices / static_cast<double>(thread_count) *
+                                 (is_compact_matrix ? COMPACT_ALL_PAIRS_SECONDS_PER_CUBED_VERTEX : ALL_PAIRS_SECONDS_PER_CUBED_VERTEX)};
+
+        const double shortcuts = SHORTCUTS_PER_EDGE * edges;
+        EngineEstimate contraction_hierarchies{EngineType::CONTRACTION_HIERARCHIES,
+                                               shortcuts * sizeof(ContractionHierarchiesRouter::Shortcut) +
+                                               (edges + shortcuts) * sizeof(graph::EdgeId) +
+                                               vertices * 3 * sizeof(size_t),
+                                               edges * CONTRACTION_SECONDS_PER_EDGE};
+
+        // Labels are built on top of the contraction order, so the hierarchy counts towards the peak memory too.
+        const double label_entries = vertices * LABEL_ENTRIES_FACTOR * std::pow(vertices, LABEL_ENTRIES_EXPONENT);
+        EngineEstimate hub_labels{EngineType::HUB_LABELS,
+                                  contraction_hierarchies.memory_mb_ +
+                                  label_entries * sizeof(HubLabelsRouter::LabelEntry) + vertices * 2 * sizeof(size_t),
+                                  contraction_hierarchies.build_seconds_ + label_entries * LABELING_SECONDS_PER_ENTRY};
+
+        const double landmarks = static_cast<double>(settings.landmark_count_);
+        EngineEstimate alt{EngineType::ALT,
+                           landmarks * vertices * 2 * sizeof(double),
+                           landmarks * 2 * edges * LANDMARK_SEARCH_SECONDS_PER_EDGE};
+
+        EngineEstimates estimates{all_pairs, hub_labels, contraction_hierarchies, alt, {EngineType::DIJKSTRA}};
+        for (EngineEstimate& estimate : estimates) {
+            estimate.memory_mb_ /= BYTES_PER_MB;
+            estimate.fits_ = estimate.memory_mb_ <= settings.max_memory_mb_ && estimate.build_seconds_ <= settings.max_build_seconds_;
+        }
+        return estimates;
+    }
+
+    size_t TransportRouter::CountGraphVertices() const {
+        if (routing_settings_.graph_model_ == GraphModel::COMPLETE) {
+            return transport_catalogue_.GetAmountOfUsedStops() * 2;
+        }
+        size_t vertex_count = transport_catalogue_.GetAmountOfUsedStops();
+        for (const domain::Bus& bus : transport_catalogue_.GetBuses()) {
+            vertex_count += bus.stops_.size() * (bus.type_ == domain::BusType::REVERSE ? 2 : 1);
+        }
+        return vertex_count;
+    }
+
     void TransportRouter::FillGraph() {
+        if (routing_settings_.graph_model_ == GraphModel::TRIP_BASED) {
+            FillTripBasedGraph();
+            return;
+        }
         AddWaitEdgesToGraph();
-        for (auto [name, bus_ptr] : transport_catalogue_.GetBusIndexes()) {
-            AddBusEdgesToGraph(*this, bus_ptr->stops_.begin(), bus_ptr->stops_.end(), name);
-            if (bus_ptr->type_ == domain::BusType::REVERSE) {
-                AddBusEdgesToGraph(*this, bus_ptr->stops_.crbegin(), bus_ptr->stops_.crend(), name);
+        uint32_t bus_index = 0;
+        for (const domain::Bus& bus : transport_catalogue_.GetBuses()) {
+            if (bus.stops_.empty()) {
+                ++bus_index;
+                continue;
+            }
+            AddBusEdgesToGraph(*this, bus.stops_.begin(), bus.stops_.end(), bus_index, 0);
+            if (bus.type_ == domain::BusType::REVERSE) {
+                AddBusEdgesToGraph(*this, bus.stops_.crbegin(), bus.stops_.crend(), bus_index, bus.stops_.size() - 1);
+            }
+            ++bus_index;
+        }
+    }
+
+    void TransportRouter::FillTripBasedGraph() {
+        graph::VertexId vertex_id = 0;
+        for (std::string_view name: stop_names_) {
+            pairs_of_vertices_for_each_stop_.insert({name, {vertex_id, vertex_id}});
+            ++vertex_id;
+        }
+        uint32_t bus_index = 0;
+        for (const domain::Bus& bus : transport_catalogue_.GetBuses()) {
+            vertex_id = AddBusRideEdgesToGraph(*this, bus.stops_.begin(), bus.stops_.end(), bus_index, 0, vertex_id);
+            if (bus.type_ == domain::BusType::REVERSE) {
+                vertex_id = AddBusRideEdgesToGraph(*this, bus.stops_.crbegin(), bus.stops_.crend(), bus_index,
+                                                   bus.stops_.size() - 1, vertex_id);
+            }
+            ++bus_index;
+        }
+    }
+
+    void TransportRouter::FreezeGraph() {
+        const std::vector<graph::EdgeId> old_edge_ids = graph_->Freeze();
+        EdgeRecords edge_records;
+        edge_records.reserve(edge_records_.size());
+        for (const graph::EdgeId edge_id : old_edge_ids) {
+            edge_records.push_back(edge_records_[edge_id]);
+        }
+        edge_records_ = std::move(edge_records);
+    }
+
+    // A traversal runs along the stops of the bus and, unless it is a roundtrip, back without repeating the last stop.
+    void TransportRouter::FillBusDistances() {
+        bus_distance_offsets_.clear();
+        bus_distances_.clear();
+        for (const domain::Bus& bus : transport_catalogue_.GetBuses()) {
+            bus_distance_offsets_.push_back(bus_distances_.size());
+            std::vector<const domain::Stop*> traversal(bus.stops_.begin(), bus.stops_.end());
+            if (bus.type_ == domain::BusType::REVERSE && !bus.stops_.empty()) {
+                traversal.insert(traversal.end(), std::next(bus.stops_.crbegin()), bus.stops_.crend());
+            }
+            double distance = 0.0;
+            for (size_t i = 0; i < traversal.size(); ++i) {
+                if (i > 0) {
+                    distance += transport_catalogue_.GetDistancesBetweenStops(traversal[i - 1], traversal[i]);
+                }
+                bus_distances_.push_back(distance);
             }
         }
+        bus_distance_offsets_.push_back(bus_distances_.size());
+    }
+
+    // Buses sharing a stretch of stops add parallel edges between the same vertices, and only the fastest of them can
+    // be on a shortest path. Bus edge times are proportional to distance, so this holds for every metric as well.
+    // The earliest added of the fastest edges is kept, the buses of the other fastest ones become its alternatives.
+    void TransportRouter::PruneParallelEdges() {
+        const size_t vertex_count = graph_->GetVertexCount();
+        std::vector<size_t> offsets(vertex_count + 1, 0);
+        std::vector<graph::VertexId> targets;
+        std::vector<double> weights;
+        EdgeRecords edge_records;
+        targets.reserve(graph_->GetEdgeCount());
+        weights.reserve(graph_->GetEdgeCount());
+        edge_records.reserve(graph_->GetEdgeCount());
+
+        std::unordered_map<graph::VertexId, graph::EdgeId> fastest_edges;
+        std::unordered_map<graph::VertexId, graph::EdgeId> kept_edges;
+        for (graph::VertexId from = 0; from < vertex_count; ++from) {
+            fastest_edges.clear();
+            kept_edges.clear();
+            for (graph::EdgeId edge_id : graph_->GetIncidentEdges(from)) {
+                const auto& edge = graph_->GetEdge(edge_id);
+                auto [fastest, is_first] = fastest_edges.emplace(edge.to, edge_id);
+                if (!is_first && edge.weight < graph_->GetEdge(fastest->second).weight) {
+                    fastest->second = edge_id;
+                }
+            }
+            for (graph::EdgeId edge_id : graph_->GetIncidentEdges(from)) {
+                const auto& edge = graph_->GetEdge(edge_id);
+                const graph::EdgeId fastest_id = fastest_edges.at(edge.to);
+                if (edge_id == fastest_id) {
+                    kept_edges.emplace(edge.to, targets.size());
+                    targets.push_back(edge.to);
+                    weights.push_back(edge.weight);
+                    edge_records.push_back(edge_records_[edge_id]);
+                    continue;
+                }
+                const EdgeRecord& record = edge_records_[edge_id];
+                if (edge.weight != graph_->GetEdge(fastest_id).weight || record.type_ != EdgeType::BUS ||
+                        record.index_ == edge_records_[fastest_id].index_) {
+                    continue;
+                }
+                std::string_view bus_name = transport_catalogue_.GetBuses()[record.index_].name_;
+                auto& alternatives = alternative_buses_[kept_edges.at(edge.to)];
+                if (std::find(alternatives.begin(), alternatives.end(), bus_name) == alternatives.end()) {
+                    alternatives.push_back(bus_name);
+                }
+            }
+            offsets[from + 1] = targets.size();
+        }
+
+        if (targets.size() == graph_->GetEdgeCount()) return;
+        *graph_ = Graph(std::move(offsets), targets, weights);
+        edge_records_ = std::move(edge_records);
+    }
+
+    // RAPTOR reads the stop sequences of the buses, so the graph stays empty and every stop is its own vertex.
+    void TransportRouter::BuildRaptorGraph() {
+        pairs_of_vertices_for_each_stop_.clear();
+        edge_records_.clear();
+        alternative_buses_.clear();
+        for (size_t stop_index = 0; stop_index < stop_names_.size(); ++stop_index) {
+            pairs_of_vertices_for_each_stop_.insert({stop_names_[stop_index], {stop_index, stop_index}});
+        }
+        FillBusDistances();
+        *graph_ = Graph(std::vector<size_t>(1, 0), {}, {});
+        BuildRaptorRouter();
+    }
+
+    void TransportRouter::BuildRaptorRouter() {
+        raptor_router_ = std::make_unique<raptor::RaptorRouter>(
+                transport_catalogue_.GetBuses(), stop_names_,
+                [this](uint32_t bus_index, uint32_t position) { return GetBusDistance(bus_index, 0, position); },
+                routing_settings_.max_transfers_);
+    }
+
+    void TransportRouter::RebuildGraph() {
+        pairs_of_vertices_for_each_stop_.clear();
+        edge_records_.clear();
+        alternative_buses_.clear();
+        FillBusDistances();
+        *graph_ = Graph(CountGraphVertices());
+        FillGraph();
+        FreezeGraph();
+        PruneParallelEdges();
+    }
+
+    // Dijkstra needs no preprocessing and always fits, so AUTO falls back to it.
+    void TransportRouter::SelectRouterEngine() {
+        if (routing_settings_.engine_ != EngineType::AUTO) return;
+        engine_estimates_ = EstimateEngines(routing_settings_, graph_->GetVertexCount(), graph_->GetEdgeCount());
+        routing_settings_.engine_ = EngineType::DIJKSTRA;
+        for (const EngineEstimate& estimate : engine_estimates_) {
+            if (estimate.fits_) {
+                routing_settings_.engine_ = estimate.engine_;
+                break;
+            }
+        }
+    }
+
+    void TransportRouter::BuildRouterEngine() {
+        switch (routing_settings_.engine_) {
+            case EngineType::ALL_PAIRS:
+                switch (routing_settings_.weight_type_) {
+                    case WeightType::DOUBLE:
+                        router_ = std::make_unique<Router>(*graph_, routing_settings_.precompute_threads_);
+                        break;
+                    case WeightType::FLOAT:
+                        router_ = std::make_unique<FloatRouter>(*graph_, routing_settings_.precompute_threads_);
+                        break;
+                    case WeightType::FIXED_POINT:
+                        router_ = std::make_unique<FixedPointRouter>(*graph_, routing_settings_.precompute_threads_);
+                        break;
+                }
+                break;
+            case EngineType::DIJKSTRA:
+                router_ = std::make_unique<DijkstraRouter>(*graph_);
+                break;
+            case EngineType::CONTRACTION_HIERARCHIES:
+                router_ = std::make_unique<ContractionHierarchiesRouter>(*graph_);
+                break;
+            case EngineType::HUB_LABELS:
+                router_ = std::make_unique<HubLabelsRouter>(*graph_);
+                break;
+            case EngineType::ALT:
+                router_ = std::make_unique<AltRouter>(*graph_, routing_settings_.landmark_count_);
+                break;
+            case EngineType::RAPTOR:
+                // Built by BuildRaptorRouter instead, it has no graph to work on.
+                break;
+            case EngineType::AUTO:
+                // Replaced by the chosen engine in SelectRouterEngine.
+                break;
+        }
     }
 
     void TransportRouter::AddWaitEdgesToGraph() {
         graph::VertexId from_id = 0;
         graph::VertexId to_id = 1;
-        for (std::string_view name: transport_catalogue_.GetUsedStopNames()) {
+        uint32_t stop_index = 0;
+        for (std::string_view name: stop_names_) {
             graph_->AddEdge({from_id, to_id, routing_settings_.bus_wait_time_});
             pairs_of_vertices_for_each_stop_.insert({name, {from_id, to_id}});
-            edges_descriptions_.push_back({
-                EdgeType::WAIT,
-                name,
-                routing_settings_.bus_wait_time_,
-                std::nullopt
-            });
+            edge_records_.push_back({EdgeType::WAIT, stop_index++});
             from_id += 2;
             to_id += 2;
         }
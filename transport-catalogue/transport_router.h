@@ -2,33 +2,181 @@
 
 #include "transport_catalogue.h"
 #include "router.h"
+#include "dijkstra_router.h"
+#include "contraction_hierarchies.h"
+#include "hub_labels.h"
+#include "alt_router.h"
+#include "raptor_router.h"
 #include "graph.h"
+#include "lru_cache.h"
 #include <memory>
+#include <variant>
 
 namespace transport_router {
     constexpr static double METERS_PER_KM = 1000.0;
     constexpr static double MIN_PER_HOUR = 60.0;
+    constexpr static size_t CUSTOMIZED_ROUTERS_CACHE_CAPACITY = 4;
+
+    enum class EngineType {
+        ALL_PAIRS,
+        DIJKSTRA,
+        CONTRACTION_HIERARCHIES,
+        HUB_LABELS,
+        ALT,
+        // No routing graph is built.
+        RAPTOR,
+        // The fastest engine that fits the budgets.
+        AUTO
+    };
+
+    // Edges per bus: O(k^2) for COMPLETE, O(k) for TRIP_BASED.
+    enum class GraphModel {
+        COMPLETE,
+        TRIP_BASED
+    };
+
+    // Matrix cell type of the all-pairs engine. FIXED_POINT stores hundredths of a minute.
+    enum class WeightType {
+        DOUBLE,
+        FLOAT,
+        FIXED_POINT
+    };
+
+    // The routing settings that edge weights depend on.
+    struct RouteMetric {
+        double bus_wait_time_ = 0.0;
+        double bus_velocity_ = 0.0;
+
+        bool operator==(const RouteMetric& other) const {
+            return bus_wait_time_ == other.bus_wait_time_ && bus_velocity_ == other.bus_velocity_;
+        }
+    };
 
     struct RoutingSettings {
         double bus_wait_time_ = 0.0;
         double bus_velocity_ = 0.0;
+        EngineType engine_ = EngineType::ALL_PAIRS;
+        size_t precompute_threads_ = 1;
+        GraphModel graph_model_ = GraphModel::COMPLETE;
+        size_t route_cache_capacity_ = 0;
+        WeightType weight_type_ = WeightType::DOUBLE;
+        size_t landmark_count_ = 16;
+        // Budgets of the AUTO engine.
+        double max_memory_mb_ = 1024.0;
+        double max_build_seconds_ = 60.0;
+        // Rides of a RAPTOR route beyond the first one.
+        size_t max_transfers_ = raptor::RaptorRouter::UNLIMITED_TRANSFERS;
+    };
+
+    // Predicted preprocessing cost of an engine.
+    struct EngineEstimate {
+        EngineType engine_;
+        double memory_mb_ = 0.0;
+        double build_seconds_ = 0.0;
+        bool fits_ = false;
     };
 
+    using EngineEstimates = std::vector<EngineEstimate>;
+
     enum class EdgeType {
         WAIT,
-        BUS
+        BUS,
+        ALIGHT
     };
 
+    // A BUS edge rides span_count_ stops of bus index_ from first_stop_ of its traversal.
+    // WAIT and ALIGHT edges refer to used stop index_.
+    struct EdgeRecord {
+        EdgeType type_;
+        uint32_t index_ = 0;
+        uint32_t first_stop_ = 0;
+        uint32_t span_count_ = 0;
+    };
+
+    // An edge record spelled out for a route answer.
     struct EdgeDescription {
         EdgeType type_;
         std::string_view edge_name_;
         double time_ = 0.0;
         std::optional<int> span_count_ = 0;
+        // In meters, BUS edges only.
+        double distance_ = 0.0;
+        // Other buses that ride the same stretch equally fast.
+        const std::vector<std::string_view>* alternative_buses_ = nullptr;
     };
 
     using Router = graph::Router<double>;
+    using FloatRouter = graph::Router<double, float>;
+    using FixedPointRouter = graph::Router<double, uint32_t>;
+    using DijkstraRouter = graph::DijkstraRouter<double>;
+    using ContractionHierarchiesRouter = graph::ContractionHierarchiesRouter<double>;
+    using HubLabelsRouter = graph::HubLabelsRouter<double>;
+    using AltRouter = graph::AltRouter<double>;
+    using RouterEngine = std::variant<std::unique_ptr<Router>,
+                                      std::unique_ptr<FloatRouter>,
+                                      std::unique_ptr<FixedPointRouter>,
+                                      std::unique_ptr<DijkstraRouter>,
+                                      std::unique_ptr<ContractionHierarchiesRouter>,
+                                      std::unique_ptr<HubLabelsRouter>,
+                                      std::unique_ptr<AltRouter>>;
     using Graph = graph::DirectedWeightedGraph<double>;
+    using EdgeRecords = std::vector<EdgeRecord>;
     using EdgeDescriptions = std::vector<EdgeDescription>;
+    // Buses of equally fast pruned edges, by the id of the kept edge.
+    using AlternativeBuses = std::unordered_map<graph::EdgeId, std::vector<std::string_view>>;
+    using RouteDescription = std::shared_ptr<const EdgeDescriptions>;
+    using TimeMatrix = std::vector<std::vector<std::optional<double>>>;
+
+    struct ReachableStop {
+        std::string_view stop_name_;
+        double time_ = 0.0;
+    };
+
+    using Isochrone = std::vector<ReachableStop>;
+
+    // What ApplyCatalogueDeltas had to redo.
+    struct RouterUpdateStatistics {
+        bool rebuilt_ = false;
+        size_t raised_edges_ = 0;
+        size_t lowered_edges_ = 0;
+        // Rows of the all-pairs matrix searched again, the rest were kept.
+        size_t searched_rows_ = 0;
+    };
+
+    // Vertex ids fit in 32 bits, so a pair packs into one 64-bit key.
+    class VerticesPairHasher {
+    private:
+        std::hash<uint64_t> hasher_;
+    public:
+        size_t operator()(const std::pair<graph::VertexId, graph::VertexId>& vertices) const {
+            return hasher_(static_cast<uint64_t>(vertices.first) << 32 | static_cast<uint32_t>(vertices.second));
+        }
+    };
+
+    using RouteCache = cache::LruCache<std::pair<graph::VertexId, graph::VertexId>, RouteDescription, VerticesPairHasher>;
+
+    class RouteMetricHasher {
+    private:
+        std::hash<double> hasher_;
+    public:
+        size_t operator()(const RouteMetric& metric) const {
+            size_t hash = hasher_(metric.bus_wait_time_);
+            hash ^= hasher_(metric.bus_velocity_) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+            return hash;
+        }
+    };
+
+    // Graph re-weighted for another metric.
+    struct CustomizedRouter {
+        std::unique_ptr<Graph> graph_;
+        std::unique_ptr<DijkstraRouter> router_;
+    };
+
+    using CustomizedRouterCache = cache::LruCache<RouteMetric, std::shared_ptr<const CustomizedRouter>, RouteMetricHasher>;
+
+    std::string_view GetEngineName(EngineType engine);
+    // Fastest to answer first.
+    EngineEstimates EstimateEngines(const RoutingSettings& settings, size_t vertex_count, size_t edge_count);
 
     class TransportRouter {
     public:
@@ -37,30 +185,84 @@ namespace transport_router {
         TransportRouter(RoutingSettings routing_settings,
                         const transport_catalogue::TransportCatalogue& transport_catalogue,
                         std::unique_ptr<Graph>&& graph,
-                        std::unique_ptr<Router>&& router,
+                        RouterEngine&& router,
                         std::unordered_map<std::string_view, std::pair<size_t, size_t>>&& pairs_of_vertices_for_each_stop,
-                        EdgeDescriptions&& edges_descriptions);
+                        EdgeRecords&& edge_records,
+                        AlternativeBuses&& alternative_buses = {},
+                        EngineEstimates&& engine_estimates = {});
 
         const RoutingSettings& GetRoutingSettings() const &;
         const transport_catalogue::TransportCatalogue& GetTransportCatalogue() const &;
         std::unique_ptr<Graph>& GetGraph() &;
         const std::unique_ptr<Graph>& GetGraph() const &;
-        const std::unique_ptr<Router>& GetRouter() const &;
-        EdgeDescriptions& GetEdgeDescription() &;
+        const RouterEngine& GetRouter() const &;
+        EdgeRecords& GetEdgeRecords() &;
         const std::unordered_map<std::string_view, std::pair<size_t, size_t>>& GetPairsOfVertices() const &;
-        const EdgeDescriptions& GetEdgeDescriptions() const &;
+        const EdgeRecords& GetEdgeRecords() const &;
+        double GetBusDistance(uint32_t bus_index, uint32_t first_stop, uint32_t span_count) const;
+        // The only place where the metric enters the graph.
+        double ComputeEdgeTime(const EdgeRecord& record, const RouteMetric& metric) const;
+        const AlternativeBuses& GetAlternativeBuses() const &;
+        // Empty unless the engine was chosen by AUTO.
+        const EngineEstimates& GetEngineEstimates() const &;
+
+        // nullptr if there is no route. Answers are shared with the cache.
+        RouteDescription BuildRoute(std::string_view stop_from, std::string_view stop_to) const;
+        // All routes from one stop in one search.
+        std::vector<RouteDescription> BuildRoutes(std::string_view stop_from, const std::vector<std::string_view>& stops_to) const;
+        // Other metrics are answered by Dijkstra over a re-weighted graph.
+        std::vector<RouteDescription> BuildRoutes(std::string_view stop_from, const std::vector<std::string_view>& stops_to,
+                                                  const RouteMetric& metric) const;
+        RouteMetric GetRouteMetric() const;
+        // Total times only, one row per source stop. Cells with no route are empty.
+        TimeMatrix BuildTimeMatrix(const std::vector<std::string_view>& stops_from,
+                                   const std::vector<std::string_view>& stops_to) const;
+        // Stops reachable within max_time, ordered by arrival time. Returns nullopt for an unknown stop.
+        std::optional<Isochrone> BuildIsochrone(std::string_view stop_from, double max_time) const;
+        cache::CacheStatistics GetRouteCacheStatistics() const;
+        // Settled vertices of the searches answered so far. Only the ALT engine collects them.
+        std::optional<graph::SearchStatistics> GetSearchStatistics() const;
 
-        std::optional<EdgeDescriptions> BuildRoute(std::string_view stop_from, std::string_view stop_to) const;
+        // The catalogue must have applied the same deltas already.
+        RouterUpdateStatistics ApplyCatalogueDeltas(const transport_catalogue::CatalogueDeltas& deltas);
 
     private:
         RoutingSettings routing_settings_;
         const transport_catalogue::TransportCatalogue& transport_catalogue_;
         std::unique_ptr<Graph> graph_;
-        std::unique_ptr<Router> router_;
+        RouterEngine router_;
         std::unordered_map<std::string_view, std::pair<size_t, size_t>> pairs_of_vertices_for_each_stop_;
-        EdgeDescriptions edges_descriptions_;
+        EdgeRecords edge_records_;
+        AlternativeBuses alternative_buses_;
+        std::vector<std::string_view> stop_names_;
+        // Cumulative, bus_distance_offsets_[i] is where bus i starts.
+        std::vector<size_t> bus_distance_offsets_;
+        std::vector<double> bus_distances_;
+        std::unique_ptr<RouteCache> route_cache_;
+        std::unique_ptr<CustomizedRouterCache> customized_routers_;
+        EngineEstimates engine_estimates_;
+        // Replaces router_ for RAPTOR.
+        std::unique_ptr<raptor::RaptorRouter> raptor_router_;
 
+        RouteDescription MakeRouteDescription(const std::optional<graph::RouteInfo<double>>& route, const Graph& graph) const;
+        EdgeDescription MakeEdgeDescription(graph::EdgeId edge_id, double time) const;
+        RouteDescription MakeRouteDescription(const std::optional<raptor::Journey>& journey, const RouteMetric& metric) const;
+        raptor::SearchTree SearchRaptor(graph::VertexId from, const std::vector<graph::VertexId>& targets,
+                                        const RouteMetric& metric, std::optional<double> max_time = std::nullopt) const;
+        std::vector<RouteDescription> BuildRaptorRoutes(graph::VertexId from, const std::vector<graph::VertexId>& targets,
+                                                        const RouteMetric& metric) const;
+        void BuildRaptorGraph();
+        void BuildRaptorRouter();
+        void FillBusDistances();
+        std::shared_ptr<const CustomizedRouter> GetCustomizedRouter(const RouteMetric& metric) const;
+        size_t CountGraphVertices() const;
         void FillGraph();
+        void FillTripBasedGraph();
+        void FreezeGraph();
+        void PruneParallelEdges();
+        void RebuildGraph();
+        void SelectRouterEngine();
+        void BuildRouterEngine();
         void AddWaitEdgesToGraph();
     };
 }